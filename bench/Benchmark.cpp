@@ -0,0 +1,416 @@
+#include "Benchmark.hpp"
+#include "BatchPropagator.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <new>
+#include <stdexcept>
+#include <thread>
+
+#include <sys/resource.h>
+
+/* Allocation counting: every heap allocation of the process goes through these */
+
+namespace
+{
+    std::atomic<std::uint64_t> allocations{0};
+
+    void* allocate(std::size_t size, std::size_t alignment)
+    {
+        allocations.fetch_add(1, std::memory_order_relaxed);
+
+        void* p;
+        if (alignment <= alignof(std::max_align_t))
+            p = std::malloc(size == 0 ? 1 : size);
+        else
+            p = std::aligned_alloc(alignment, (size + alignment - 1)/alignment*alignment);
+
+        if (!p) throw std::bad_alloc();
+        return p;
+    }
+}
+
+void* operator new(std::size_t size)
+{
+    return allocate(size, 0);
+}
+
+void* operator new(std::size_t size, std::align_val_t alignment)
+{
+    return allocate(size, static_cast<std::size_t>(alignment));
+}
+
+void operator delete(void* p) noexcept
+{
+    std::free(p);
+}
+
+void operator delete(void* p, std::size_t) noexcept
+{
+    std::free(p);
+}
+
+void operator delete(void* p, std::align_val_t) noexcept
+{
+    std::free(p);
+}
+
+void operator delete(void* p, std::size_t, std::align_val_t) noexcept
+{
+    std::free(p);
+}
+
+std::uint64_t allocationCount()
+{
+    return allocations.load(std::memory_order_relaxed);
+}
+
+void resetPeakRss()
+{
+    // Linux resets the peak of /proc/self/status when 5 is written here
+    std::ofstream clear{"/proc/self/clear_refs"};
+    if (clear.is_open()) clear << "5";
+}
+
+long peakRss()
+{
+    std::ifstream status{"/proc/self/status"};
+    std::string key;
+    while (status >> key)
+    {
+        long kb;
+        if (key == "VmHWM:" && status >> kb)
+            return kb;
+        status.ignore(1 << 16, '\n');
+    }
+
+    // Peak of the whole process otherwise
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_maxrss;
+}
+
+/* MacroRun */
+
+void MacroRun::start()
+{
+    startAllocations = allocationCount();
+    begin = std::chrono::steady_clock::now();
+}
+
+void MacroRun::stop()
+{
+    seconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+    allocations += allocationCount() - startAllocations;
+}
+
+void MacroRun::setCount(double count)
+{
+    this->count = count;
+}
+
+void MacroRun::setMetric(const std::string& name, double value)
+{
+    metrics.emplace_back(name, value);
+}
+
+double MacroRun::getSeconds() const
+{
+    return seconds;
+}
+
+double MacroRun::getCount() const
+{
+    return count;
+}
+
+std::uint64_t MacroRun::getAllocations() const
+{
+    return allocations;
+}
+
+const std::vector<std::pair<std::string, double>>& MacroRun::getMetrics() const
+{
+    return metrics;
+}
+
+/* BenchmarkSuite */
+
+namespace
+{
+    double median(std::vector<double> values)
+    {
+        std::sort(values.begin(), values.end());
+        const std::size_t n = values.size();
+        return n % 2 ? values[n/2] : (values[n/2 - 1] + values[n/2])/2;
+    }
+
+    /// @return seconds taken by @param n calls of @param body
+    double time(const MicroBody& body, std::uint64_t n)
+    {
+        auto begin = std::chrono::steady_clock::now();
+        body(n);
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+    }
+
+    /// @return plural of @param unit
+    std::string plural(const std::string& unit)
+    {
+        if (!unit.empty() && unit.back() == 'y')
+            return unit.substr(0, unit.size() - 1) + "ies";
+        return unit + "s";
+    }
+}
+
+BenchmarkSuite::BenchmarkSuite(BenchmarkOptions options) : options(std::move(options))
+{
+}
+
+void BenchmarkSuite::micro(const std::string& name, std::function<MicroBody()> setup)
+{
+    for (const Entry& entry : entries)
+    {
+        if (entry.name == name)
+            throw std::invalid_argument("There is already a benchmark named " + name);
+    }
+    entries.push_back({name, "call", std::move(setup), nullptr});
+}
+
+void BenchmarkSuite::macro(const std::string& name, const std::string& unit, MacroBody body)
+{
+    for (const Entry& entry : entries)
+    {
+        if (entry.name == name)
+            throw std::invalid_argument("There is already a benchmark named " + name);
+    }
+    entries.push_back({name, unit, nullptr, std::move(body)});
+}
+
+bool BenchmarkSuite::runs(double size) const
+{
+    return !options.quick || size <= 1e5;
+}
+
+std::vector<std::string> BenchmarkSuite::list() const
+{
+    std::vector<std::string> names;
+    for (const Entry& entry : entries)
+    {
+        if (selected(entry))
+            names.push_back(entry.name);
+    }
+    return names;
+}
+
+std::vector<BenchmarkResult> BenchmarkSuite::run(std::ostream& log) const
+{
+    std::vector<BenchmarkResult> results;
+    for (const Entry& entry : entries)
+    {
+        if (!selected(entry)) continue;
+
+        log << entry.name << "... " << std::flush;
+        results.push_back(entry.body ? runMacro(entry) : runMicro(entry));
+
+        const BenchmarkResult& result = results.back();
+        log << result.seconds/result.count*1e9 << " ns/" << result.unit << ", "
+            << result.allocationsPerUnit << " allocations/" << result.unit << std::endl;
+    }
+    return results;
+}
+
+bool BenchmarkSuite::selected(const Entry& entry) const
+{
+    return entry.name.find(options.filter) != std::string::npos;
+}
+
+BenchmarkResult BenchmarkSuite::runMicro(const Entry& entry) const
+{
+    resetPeakRss();
+    MicroBody body = entry.setup();
+
+    // Double the calls until they take a measurable time, then aim at the target time
+    const double target = options.quick ? 0.01 : 0.1;
+    std::uint64_t n{1};
+    double seconds = time(body, n);
+    while (seconds < target/8)
+    {
+        n *= 2;
+        seconds = time(body, n);
+    }
+    n = std::max<std::uint64_t>(1, static_cast<std::uint64_t>(n*target/seconds));
+
+    const unsigned int repetitions = options.quick ? 3 : std::max(options.repetitions, 1u);
+    std::vector<double> times;
+    const std::uint64_t before = allocationCount();
+    for (unsigned int r = 0; r < repetitions; r++)
+        times.push_back(time(body, n));
+    const std::uint64_t allocated = allocationCount() - before;
+
+    return {entry.name, "micro", entry.unit, double(n), median(times),
+            double(allocated)/(double(n)*repetitions), peakRss(), {}};
+}
+
+BenchmarkResult BenchmarkSuite::runMacro(const Entry& entry) const
+{
+    resetPeakRss();
+
+    // Large runs vary little between repetitions and take long: at most 3
+    const unsigned int repetitions = options.quick ? 1 : std::min(std::max(options.repetitions, 1u), 3u);
+    std::vector<double> times;
+    MacroRun last;
+    for (unsigned int r = 0; r < repetitions; r++)
+    {
+        MacroRun run;
+        entry.body(run);
+        times.push_back(run.getSeconds());
+        last = std::move(run);
+    }
+
+    const double count = std::max(last.getCount(), 1.0);
+    return {entry.name, "macro", entry.unit, count, median(times),
+            last.getAllocations()/count, peakRss(), last.getMetrics()};
+}
+
+/* JSON output */
+
+namespace
+{
+    /// Writes @param value as a JSON number, or null if it is not finite
+    void writeNumber(std::ostream& os, double value)
+    {
+        if (std::isfinite(value)) os << value;
+        else os << "null";
+    }
+
+    void writeString(std::ostream& os, const std::string& value)
+    {
+        os << '"';
+        for (char c : value)
+        {
+            if (c == '"' || c == '\\') os << '\\';
+            os << c;
+        }
+        os << '"';
+    }
+}
+
+void writeJson(std::ostream& os, const std::vector<BenchmarkResult>& results)
+{
+    const auto precision = os.precision(6);
+
+    os << "{\n  \"context\": {\"compiler\": ";
+    writeString(os, __VERSION__);
+#ifdef __OPTIMIZE__
+    os << ", \"optimized\": true";
+#else
+    os << ", \"optimized\": false";
+#endif
+    os << ", \"batch_kernel\": ";
+    writeString(os, BatchPropagator::getKernelName());
+    os << ", \"hardware_threads\": " << std::thread::hardware_concurrency() << "},\n";
+
+    os << "  \"benchmarks\": [";
+    for (std::size_t i = 0; i < results.size(); i++)
+    {
+        const BenchmarkResult& r = results[i];
+        const std::string units = plural(r.unit);
+
+        os << (i ? ",\n" : "\n") << "    {\"name\": ";
+        writeString(os, r.name);
+        os << ", \"kind\": ";
+        writeString(os, r.kind);
+        os << ", \"" << units << "\": ";
+        writeNumber(os, r.count);
+        os << ", \"seconds\": ";
+        writeNumber(os, r.seconds);
+        os << ", \"ns_per_" << r.unit << "\": ";
+        writeNumber(os, r.seconds/r.count*1e9);
+        os << ", \"" << units << "_per_second\": ";
+        writeNumber(os, r.count/r.seconds);
+        os << ", \"allocations_per_" << r.unit << "\": ";
+        writeNumber(os, r.allocationsPerUnit);
+        os << ", \"peak_rss_kb\": " << r.peakRssKb;
+        for (const auto& metric : r.metrics)
+        {
+            os << ", ";
+            writeString(os, metric.first);
+            os << ": ";
+            writeNumber(os, metric.second);
+        }
+        os << "}";
+    }
+    os << "\n  ]\n}" << std::endl;
+
+    os.precision(precision);
+}
+
+/* main */
+
+namespace
+{
+    void usage(const char* program)
+    {
+        std::cerr << "Usage: " << program << " [--filter text] [--quick] [--repetitions n] [--output file.json] [--list]\n"
+                  << "Runs the benchmarks whose name contains the filter and writes the results as JSON" << std::endl;
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    BenchmarkOptions options;
+    std::string output;
+    bool list{false};
+
+    for (int i = 1; i < argc; i++)
+    {
+        const bool hasValue = i + 1 < argc;
+        if (std::strcmp(argv[i], "--filter") == 0 && hasValue) options.filter = argv[++i];
+        else if (std::strcmp(argv[i], "--quick") == 0) options.quick = true;
+        else if (std::strcmp(argv[i], "--repetitions") == 0 && hasValue) options.repetitions = std::atoi(argv[++i]);
+        else if (std::strcmp(argv[i], "--output") == 0 && hasValue) output = argv[++i];
+        else if (std::strcmp(argv[i], "--list") == 0) list = true;
+        else
+        {
+            usage(argv[0]);
+            return 2;
+        }
+    }
+
+    BenchmarkSuite suite{options};
+    addMicroBenchmarks(suite);
+    addMacroBenchmarks(suite);
+
+    if (list)
+    {
+        for (const std::string& name : suite.list())
+            std::cout << name << std::endl;
+        return 0;
+    }
+
+#ifndef __OPTIMIZE__
+    std::cerr << "Warning: benchmarks built without optimization, configure with -DCMAKE_BUILD_TYPE=Release" << std::endl;
+#endif
+
+    std::vector<BenchmarkResult> results = suite.run(std::cerr);
+
+    if (output.empty())
+    {
+        writeJson(std::cout, results);
+        return 0;
+    }
+
+    std::ofstream file{output, std::ios::trunc};
+    writeJson(file, results);
+    file.close();
+    if (!file)
+    {
+        std::cerr << "Could not write file " << output << std::endl;
+        return 1;
+    }
+    return 0;
+}
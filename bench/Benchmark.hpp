@@ -0,0 +1,143 @@
+#ifndef BENCHMARK_HPP
+#define BENCHMARK_HPP
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <ostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+/// Keeps the compiler from optimizing away the computation of @param value
+template<class T>
+inline void keep(const T& value)
+{
+    asm volatile("" : : "r,m"(value) : "memory");
+}
+
+/// Runs @param n calls of the code under test
+using MicroBody = std::function<void(std::uint64_t n)>;
+
+/** Measures one run of a macro benchmark: only what runs between start
+ *  and stop is timed and has its allocations counted
+ */
+class MacroRun
+{
+    public:
+    void start();
+    void stop();
+
+    /// Sets the number of units (steps, entries...) done in the timed part
+    void setCount(double count);
+
+    /// Adds @param value to the results as is, such as the error of the run
+    void setMetric(const std::string& name, double value);
+
+    double getSeconds() const;
+    double getCount() const;
+    std::uint64_t getAllocations() const;
+    const std::vector<std::pair<std::string, double>>& getMetrics() const;
+
+    private:
+    std::chrono::steady_clock::time_point begin;
+    double seconds{0}, count{0};
+    std::uint64_t startAllocations{0}, allocations{0};
+    std::vector<std::pair<std::string, double>> metrics;
+};
+
+/// Measures one macro benchmark run
+using MacroBody = std::function<void(MacroRun& run)>;
+
+/// Measurements of a benchmark, written as a JSON object
+struct BenchmarkResult
+{
+    std::string name;
+    /// "micro" or "macro"
+    std::string kind;
+    /// What count counts: "call", "step", "entry"...
+    std::string unit;
+    /// Units done in each repetition
+    double count;
+    /// Median time of a repetition in seconds
+    double seconds;
+    double allocationsPerUnit;
+    /// Peak resident set size during the benchmark, setup included
+    long peakRssKb;
+    std::vector<std::pair<std::string, double>> metrics;
+};
+
+struct BenchmarkOptions
+{
+    /// Only benchmarks whose name contains it run
+    std::string filter;
+    /// Shorter runs and only the smallest macro benchmarks, to check that everything works
+    bool quick{false};
+    /// Repetitions of each benchmark, of which the median is kept
+    unsigned int repetitions{5};
+};
+
+/** Benchmarks registered by name and run on demand. Setup code runs only if
+ *  the benchmark is selected and is never timed. Micro benchmarks are
+ *  calibrated to a number of calls that takes a measurable time, macro
+ *  benchmarks do the same work every time.
+ */
+class BenchmarkSuite
+{
+    public:
+    explicit BenchmarkSuite(BenchmarkOptions options);
+
+    /** Adds micro benchmark @param name, whose body is made by @param setup
+     *  @throw std::invalid_argument if there is already a benchmark with that name
+     */
+    void micro(const std::string& name, std::function<MicroBody()> setup);
+
+    /** Adds macro benchmark @param name, counting @param unit in each run of @param body
+     *  @throw std::invalid_argument if there is already a benchmark with that name
+     */
+    void macro(const std::string& name, const std::string& unit, MacroBody body);
+
+    /// @return true iff macro benchmarks of @param size units of work are run with these options
+    bool runs(double size) const;
+
+    /// @return names of the benchmarks selected by the filter
+    std::vector<std::string> list() const;
+
+    /// Runs the selected benchmarks in order of registration, reporting progress to @param log
+    std::vector<BenchmarkResult> run(std::ostream& log) const;
+
+    private:
+    struct Entry
+    {
+        std::string name, unit;
+        std::function<MicroBody()> setup;
+        MacroBody body;
+    };
+
+    bool selected(const Entry& entry) const;
+    BenchmarkResult runMicro(const Entry& entry) const;
+    BenchmarkResult runMacro(const Entry& entry) const;
+
+    BenchmarkOptions options;
+    std::vector<Entry> entries;
+};
+
+/// Adds the benchmarks of single operations to @param suite
+void addMicroBenchmarks(BenchmarkSuite& suite);
+
+/// Adds the benchmarks of whole propagations and exports to @param suite
+void addMacroBenchmarks(BenchmarkSuite& suite);
+
+/// @return number of heap allocations made by the process so far
+std::uint64_t allocationCount();
+
+/// Resets the peak resident set size if the system allows it, so that the next peakRss is that of what follows
+void resetPeakRss();
+
+/// @return peak resident set size in kB
+long peakRss();
+
+/// Writes @param results and the build they come from to @param os as JSON
+void writeJson(std::ostream& os, const std::vector<BenchmarkResult>& results);
+
+#endif
@@ -0,0 +1,300 @@
+#include "Benchmark.hpp"
+#include "ChebyshevEphemeris.hpp"
+#include "Enviroment.hpp"
+#include "EphemerisFile.hpp"
+#include "MultistepPropagator.hpp"
+#include "RungeKuttaPropagator.hpp"
+#include "SymplecticPropagator.hpp"
+#include "TextExporter.hpp"
+#include <cmath>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <stdexcept>
+
+namespace
+{
+    const double MU = 398600.4418, RADIUS = 6378.137;
+    const double J2 = 1.08262668e-3, J3 = -2.53265649e-6;
+    const double DEGREE = M_PI/180;
+
+    CelestialBody earth(bool zonal)
+    {
+        CelestialBody body;
+        body.setGravitationalParameter(MU);
+        if (zonal)
+        {
+            body.setJefferyConstant(2, MU*J2*RADIUS*RADIUS);
+            body.setJefferyConstant(3, MU*J3*RADIUS*RADIUS*RADIUS);
+        }
+        return body;
+    }
+
+    /// @return state at the perigee of an orbit of semi-major axis @param a, eccentricity @param e and inclination @param i
+    EphemerisEntry perigee(double a, double e, double i)
+    {
+        const double r = a*(1 - e), v = std::sqrt(MU*(1 + e)/r);
+        return EphemerisEntry(r, 0, 0, 0, v*std::cos(i), v*std::sin(i), 0);
+    }
+
+    /// Orbits of the work-precision benchmarks
+    struct Orbit
+    {
+        const char* name;
+        EphemerisEntry initial;
+        double duration;
+    };
+
+    const Orbit LEO{"leo_j2", perigee(6778, 0.001, 51.6*DEGREE), 86400};
+    const Orbit MOLNIYA{"molniya_j2", perigee(26600, 0.74, 63.4*DEGREE), 2*86400};
+
+    std::unique_ptr<Propagator> makePropagator(const std::string& name)
+    {
+        if (name == "leapfrog") return std::unique_ptr<Propagator>(new LeapfrogPropagator());
+        if (name == "yoshida4") return std::unique_ptr<Propagator>(new Yoshida4Propagator());
+        if (name == "yoshida6") return std::unique_ptr<Propagator>(new Yoshida6Propagator());
+        if (name == "yoshida8") return std::unique_ptr<Propagator>(new Yoshida8Propagator());
+        if (name == "abm") return std::unique_ptr<Propagator>(new AdamsBashforthMoultonPropagator());
+        if (name == "gj8") return std::unique_ptr<Propagator>(new GaussJacksonPropagator());
+        if (name == "dopri5") return std::unique_ptr<Propagator>(new DormandPrincePropagator());
+        if (name == "rkf78") return std::unique_ptr<Propagator>(new RungeKuttaFehlberg78Propagator());
+        throw std::invalid_argument("Unknown propagator " + name);
+    }
+
+    /// Sets up @param env to propagate @param initial with @param propagator for @param steps steps of @param dt
+    void setUp(Enviroment& env, const CelestialBody& body, const EphemerisEntry& initial,
+               const std::string& propagator, double steps, double dt)
+    {
+        env.setCentralBody(body);
+        env.getEphemeris().setInitialEntry(initial);
+        env.setTimeStep(dt);
+        env.setFinalTime(initial.getTime() + steps*dt);
+        env.setPropagator(makePropagator(propagator));
+    }
+
+    /// Throws unless propagation exit @param code of @param env is 0
+    void check(Enviroment& env, int code)
+    {
+        if (code != 0)
+            throw std::runtime_error(env.getPropagator()->getExitMessage(code));
+    }
+
+    /// Counts the entries it receives and keeps only the last one
+    class CountingSink : public EphemerisSink
+    {
+        public:
+        void begin(const EphemerisEntry& initial, unsigned int) override
+        {
+            count = 0;
+            last = initial;
+        }
+
+        void append(const EphemerisEntry& entry) override
+        {
+            count++;
+            last = entry;
+        }
+
+        unsigned int count{0};
+        EphemerisEntry last;
+    };
+
+    /// @return the name of @param size as in "1e6"
+    std::string sizeName(double size)
+    {
+        return "1e" + std::to_string(static_cast<int>(std::lround(std::log10(size))));
+    }
+
+    void addPropagationBenchmarks(BenchmarkSuite& suite)
+    {
+        const EphemerisEntry initial(9222.33, 1408.28, 813.073, -1.291, 6.344, 3.663, 0);
+        const std::pair<const char*, bool> models[] = {{"point_mass", false}, {"j2j3", true}};
+
+        // Every entry kept in memory, as the "propagate" command does
+        for (double size : {1e5, 1e6})
+        {
+            if (!suite.runs(size)) continue;
+            for (const auto& model : models)
+            {
+                const bool zonal = model.second;
+                suite.macro("propagate/leapfrog/" + std::string{model.first} + "/" + sizeName(size), "step",
+                    [=](MacroRun& run)
+                    {
+                        Enviroment env;
+                        setUp(env, earth(zonal), initial, "leapfrog", size, 1);
+                        run.start();
+                        int code = env.propagate();
+                        run.stop();
+                        check(env, code);
+                        run.setCount(env.getEphemeris().size() - 1);
+                    });
+            }
+        }
+
+        // 1e7 entries would take 560 MB: they are counted and dropped instead
+        if (suite.runs(1e7))
+        {
+            suite.macro("propagate/leapfrog/j2j3/1e7/no_storage", "step", [=](MacroRun& run)
+            {
+                Enviroment env;
+                setUp(env, earth(true), initial, "leapfrog", 1e7, 1);
+                CountingSink sink;
+                run.start();
+                int code = env.propagate(sink);
+                run.stop();
+                check(env, code);
+                run.setCount(sink.count);
+            });
+        }
+
+        // Every method on the same J2/J3 run. Adaptive methods count output steps.
+        for (const char* method : {"yoshida4", "yoshida6", "yoshida8", "abm", "gj8", "dopri5", "rkf78"})
+        {
+            const std::string name{method};
+            suite.macro("propagate/" + name + "/j2j3/1e5", "step", [=](MacroRun& run)
+            {
+                Enviroment env;
+                setUp(env, earth(true), initial, name, 1e5, 10);
+                run.start();
+                int code = env.propagate();
+                run.stop();
+                check(env, code);
+                run.setCount(env.getEphemeris().size() - 1);
+            });
+        }
+    }
+
+    /** Work-precision diagram of the fixed step methods: for each time step,
+     *  the cost of the run and the position error at its end against a
+     *  tightly tolerated RKF7(8) propagation
+     */
+    void addWorkPrecisionBenchmarks(BenchmarkSuite& suite)
+    {
+        const double REFERENCE_STEP = 7.5;
+        for (const Orbit& orbit : {LEO, MOLNIYA})
+        {
+            // Computed by the first benchmark of the orbit that runs
+            auto reference = std::make_shared<std::shared_ptr<Ephemeris>>();
+            auto getReference = [orbit, reference, REFERENCE_STEP]()
+            {
+                if (!*reference)
+                {
+                    Enviroment env;
+                    setUp(env, earth(true), orbit.initial, "rkf78", orbit.duration/REFERENCE_STEP, REFERENCE_STEP);
+                    static_cast<AdaptiveRungeKuttaPropagator*>(env.getPropagator())->setTolerances(1e-13, 1e-13);
+                    check(env, env.propagate());
+                    *reference = std::make_shared<Ephemeris>(env.getEphemeris());
+                }
+                return *reference;
+            };
+
+            for (const char* method : {"leapfrog", "yoshida4", "yoshida6", "yoshida8"})
+            {
+                for (double dt : {60.0, 30.0, 15.0, REFERENCE_STEP})
+                {
+                    const std::string name{method};
+                    char step[16];
+                    std::snprintf(step, sizeof(step), "%g", dt);
+
+                    suite.macro(std::string{"work_precision/"} + orbit.name + "/" + name + "/dt_" + step, "step",
+                        [=](MacroRun& run)
+                        {
+                            std::shared_ptr<Ephemeris> exact = getReference();
+                            Enviroment env;
+                            setUp(env, earth(true), orbit.initial, name, orbit.duration/dt, dt);
+                            CountingSink sink;
+                            run.start();
+                            int code = env.propagate(sink);
+                            run.stop();
+                            check(env, code);
+
+                            // Both end on the grid of the reference, where it is exact
+                            const EphemerisEntry expected = exact->interpolate(sink.last.getTime());
+                            run.setCount(sink.count);
+                            run.setMetric("dt_s", dt);
+                            run.setMetric("position_error_km", (sink.last.getPosition() - expected.getPosition()).norm());
+                        });
+                }
+            }
+        }
+    }
+
+    /// @return ephemeris of @param n entries every 10 s of a propagated LEO orbit
+    std::shared_ptr<Ephemeris> propagatedOrbit(double n)
+    {
+        Enviroment env;
+        setUp(env, earth(true), perigee(6778, 0.001, 51.6*DEGREE), "leapfrog", n - 1, 10);
+        check(env, env.propagate());
+        return std::make_shared<Ephemeris>(env.getEphemeris());
+    }
+
+    void addExportBenchmarks(BenchmarkSuite& suite)
+    {
+        const std::string path = (std::filesystem::temp_directory_path() / "orbital_bench_export").string();
+
+        for (double size : {1e5, 1e6})
+        {
+            if (!suite.runs(size)) continue;
+            auto ephemeris = std::make_shared<std::shared_ptr<Ephemeris>>();
+            auto getEphemeris = [ephemeris, size]()
+            {
+                if (!*ephemeris) *ephemeris = propagatedOrbit(size);
+                return *ephemeris;
+            };
+
+            // Ends with the size of the file written
+            auto finish = [path](MacroRun& run, const Ephemeris& written)
+            {
+                run.setCount(written.size());
+                run.setMetric("bytes", static_cast<double>(std::filesystem::file_size(path)));
+                std::filesystem::remove(path);
+            };
+
+            const std::pair<const char*, TextExportFormat> formats[] = {
+                {"results_to_file", TextExportFormat::ephemerisOutput()}, {"csv", TextExportFormat()}};
+            for (const auto& format : formats)
+            {
+                const TextExportFormat textFormat = format.second;
+                suite.macro("export/" + std::string{format.first} + "/" + sizeName(size), "entry", [=](MacroRun& run)
+                {
+                    std::shared_ptr<Ephemeris> ephemeris = getEphemeris();
+                    run.start();
+                    {
+                        std::ofstream file{path, std::ios::binary | std::ios::trunc};
+                        TextExporter exporter{file, textFormat};
+                        exporter.write(*ephemeris);
+                    }
+                    run.stop();
+                    finish(run, *ephemeris);
+                });
+            }
+
+            suite.macro("export/binary_file/" + sizeName(size), "entry", [=](MacroRun& run)
+            {
+                std::shared_ptr<Ephemeris> ephemeris = getEphemeris();
+                run.start();
+                EphemerisFile::write(path, *ephemeris, earth(true), 10);
+                run.stop();
+                finish(run, *ephemeris);
+            });
+
+            // Fitting within a meter dominates: the file is tiny
+            suite.macro("export/chebyshev_file/" + sizeName(size), "entry", [=](MacroRun& run)
+            {
+                std::shared_ptr<Ephemeris> ephemeris = getEphemeris();
+                run.start();
+                ChebyshevEphemeris::compress(*ephemeris, 1e-3).write(path);
+                run.stop();
+                finish(run, *ephemeris);
+            });
+        }
+    }
+}
+
+void addMacroBenchmarks(BenchmarkSuite& suite)
+{
+    addPropagationBenchmarks(suite);
+    addWorkPrecisionBenchmarks(suite);
+    addExportBenchmarks(suite);
+}
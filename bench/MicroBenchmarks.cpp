@@ -0,0 +1,346 @@
+#include "Benchmark.hpp"
+#include "ChebyshevEphemeris.hpp"
+#include "Enviroment.hpp"
+#include "GravityField.hpp"
+#include "GravityModel.hpp"
+#include "MVector.hpp"
+#include "ThirdBody.hpp"
+#include <cmath>
+#include <memory>
+#include <random>
+
+namespace
+{
+    const double MU = 398600.4418, RADIUS = 6378.137;
+    const double J2 = 1.08262668e-3, J3 = -2.53265649e-6;
+
+    /// Inputs cycle through this many values, so that no call can be folded into the next
+    const unsigned int INPUTS = 1024;
+
+    /// @return central body of the Earth, with its J2 and J3 if @param zonal
+    CelestialBody earth(bool zonal)
+    {
+        CelestialBody body;
+        body.setGravitationalParameter(MU);
+        if (zonal)
+        {
+            body.setJefferyConstant(2, MU*J2*RADIUS*RADIUS);
+            body.setJefferyConstant(3, MU*J3*RADIUS*RADIUS*RADIUS);
+        }
+        return body;
+    }
+
+    /// @return state at @param t of a circular orbit of radius 7000 km inclined 51.6 degrees
+    EphemerisEntry circularOrbit(double t)
+    {
+        const double r = 7000, w = std::sqrt(MU/(r*r*r)), inclination = 0.9006;
+        const double c = std::cos(w*t), s = std::sin(w*t);
+        const double ci = std::cos(inclination), si = std::sin(inclination);
+        return EphemerisEntry(r*c, r*s*ci, r*s*si, -r*w*s, r*w*c*ci, r*w*c*si, t);
+    }
+
+    /// @return INPUTS positions along a slightly eccentric orbit
+    std::vector<Vec3> positions()
+    {
+        std::vector<Vec3> result(INPUTS);
+        for (unsigned int i = 0; i < INPUTS; i++)
+            result[i] = circularOrbit(i*37.0).getPosition()*(1 + 0.05*std::sin(i*0.1));
+        return result;
+    }
+
+    /// @return INPUTS times uniformly distributed in [@param start, @param end]
+    std::vector<double> times(double start, double end)
+    {
+        std::mt19937_64 random{42};
+        std::uniform_real_distribution<double> uniform{start, end};
+        std::vector<double> result(INPUTS);
+        for (double& t : result)
+            t = uniform(random);
+        return result;
+    }
+
+    /// @return ephemeris of @param n entries every 10 s along circularOrbit
+    Ephemeris sampledOrbit(unsigned int n)
+    {
+        Ephemeris ephemeris;
+        ephemeris.reserve(n);
+        for (unsigned int i = 0; i < n; i++)
+            ephemeris.append(circularOrbit(i*10.0));
+        return ephemeris;
+    }
+
+    /// @return field of degree and order @param degree with coefficients of the size of the Earth's
+    GravityField syntheticField(unsigned int degree)
+    {
+        GravityField field{MU, RADIUS, degree};
+        std::mt19937_64 random{7};
+        std::normal_distribution<double> normal;
+        for (unsigned int n = 2; n <= degree; n++)
+        {
+            // Kaula's rule: normalized coefficients of degree n are about 1e-5/n^2
+            const double scale = 1e-5/(n*n);
+            for (unsigned int m = 0; m <= n; m++)
+                field.setCoefficients(n, m, scale*normal(random), m == 0 ? 0 : scale*normal(random));
+        }
+        field.setCoefficients(2, 0, -J2/std::sqrt(5.0), 0);
+        return field;
+    }
+
+    void addVectorBenchmarks(BenchmarkSuite& suite)
+    {
+        // Three element MVectors allocate every result, Vec3 keeps them on the stack
+        suite.micro("mvector/add", []()
+        {
+            return [](std::uint64_t n)
+            {
+                MVector a{1, 2, 3}, b{4, 5, 6};
+                for (std::uint64_t i = 0; i < n; i++)
+                {
+                    MVector c = a + b;
+                    keep(c[0]);
+                    a[0] = c[1]*1e-9;
+                }
+            };
+        });
+
+        suite.micro("mvector/scale", []()
+        {
+            return [](std::uint64_t n)
+            {
+                MVector a{1, 2, 3};
+                for (std::uint64_t i = 0; i < n; i++)
+                {
+                    MVector c = a*1.000001;
+                    keep(c[0]);
+                    a[0] = c[1]*1e-9;
+                }
+            };
+        });
+
+        suite.micro("mvector/cross", []()
+        {
+            return [](std::uint64_t n)
+            {
+                MVector a{1, 2, 3}, b{4, 5, 6};
+                for (std::uint64_t i = 0; i < n; i++)
+                {
+                    MVector c = a % b;
+                    keep(c[0]);
+                    a[0] = c[1]*1e-9;
+                }
+            };
+        });
+
+        suite.micro("mvector/dot", []()
+        {
+            return [](std::uint64_t n)
+            {
+                MVector a{1, 2, 3}, b{4, 5, 6};
+                for (std::uint64_t i = 0; i < n; i++)
+                {
+                    double d = a*b;
+                    keep(d);
+                    a[0] = d*1e-9;
+                }
+            };
+        });
+
+        suite.micro("vec3/add", []()
+        {
+            return [](std::uint64_t n)
+            {
+                Vec3 a{1, 2, 3}, b{4, 5, 6};
+                for (std::uint64_t i = 0; i < n; i++)
+                {
+                    Vec3 c = a + b;
+                    keep(c);
+                    a[0] = c[1]*1e-9;
+                }
+            };
+        });
+
+        suite.micro("vec3/cross", []()
+        {
+            return [](std::uint64_t n)
+            {
+                Vec3 a{1, 2, 3}, b{4, 5, 6};
+                for (std::uint64_t i = 0; i < n; i++)
+                {
+                    Vec3 c = a % b;
+                    keep(c);
+                    a[0] = c[1]*1e-9;
+                }
+            };
+        });
+    }
+
+    void addGravityBenchmarks(BenchmarkSuite& suite)
+    {
+        // Enviroment::getAcceleration builds the GravityModel of the central body on every call
+        const std::pair<const char*, bool> environments[] = {{"point_mass", false}, {"j2j3", true}};
+        for (const auto& environment : environments)
+        {
+            const bool zonal = environment.second;
+            suite.micro(std::string{"enviroment/acceleration/"} + environment.first, [zonal]()
+            {
+                auto env = std::make_shared<Enviroment>();
+                env->setCentralBody(earth(zonal));
+                auto inputs = std::make_shared<std::vector<Vec3>>(positions());
+                return [env, inputs](std::uint64_t n)
+                {
+                    for (std::uint64_t i = 0; i < n; i++)
+                        keep(env->getAcceleration(0, (*inputs)[i % INPUTS]));
+                };
+            });
+
+            suite.micro(std::string{"gravity_model/acceleration/"} + environment.first, [zonal]()
+            {
+                auto model = std::make_shared<GravityModel>(earth(zonal));
+                auto inputs = std::make_shared<std::vector<Vec3>>(positions());
+                return [model, inputs](std::uint64_t n)
+                {
+                    for (std::uint64_t i = 0; i < n; i++)
+                        keep(model->getAcceleration(0, (*inputs)[i % INPUTS]));
+                };
+            });
+        }
+
+        for (unsigned int degree : {2u, 20u, 70u})
+        {
+            suite.micro("gravity_field/degree_" + std::to_string(degree), [degree]()
+            {
+                auto evaluator = std::make_shared<GravityFieldEvaluator>(syntheticField(degree), degree, degree);
+                auto inputs = std::make_shared<std::vector<Vec3>>(positions());
+                return [evaluator, inputs](std::uint64_t n)
+                {
+                    for (std::uint64_t i = 0; i < n; i++)
+                        keep(evaluator->getAcceleration((*inputs)[i % INPUTS]));
+                };
+            });
+        }
+
+        suite.micro("third_body/sun_moon", []()
+        {
+            const double days = 30*86400.0;
+            Perturbers perturbers;
+            perturbers.add(ThirdBody::sun(0, days));
+            perturbers.add(ThirdBody::moon(0, days));
+            auto model = std::make_shared<GravityModel>(earth(false), perturbers);
+            auto inputs = std::make_shared<std::vector<Vec3>>(positions());
+            return [model, inputs](std::uint64_t n)
+            {
+                // Consecutive times of a propagation, ten seconds apart
+                for (std::uint64_t i = 0; i < n; i++)
+                    keep(model->getAcceleration((i*10) % (29*86400), (*inputs)[i % INPUTS]));
+            };
+        });
+    }
+
+    void addEphemerisBenchmarks(BenchmarkSuite& suite)
+    {
+        suite.micro("entry_builder/build/cartesian", []()
+        {
+            return [](std::uint64_t n)
+            {
+                EphemerisEntryBuilder builder;
+                builder.setY(1408.28);
+                builder.setZ(813.073);
+                builder.setVx(-1.291);
+                builder.setVy(6.344);
+                builder.setVz(3.663);
+                for (std::uint64_t i = 0; i < n; i++)
+                {
+                    builder.setX(9222.33 + (i % INPUTS));
+                    keep(builder.build());
+                }
+            };
+        });
+
+        suite.micro("entry_builder/build/keplerian", []()
+        {
+            return [](std::uint64_t n)
+            {
+                EphemerisEntryBuilder builder;
+                builder.setCelestialBody(earth(false));
+                builder.setA(7000);
+                builder.setE(0.01);
+                builder.setI(51.6);
+                builder.setLongitudeAscendingNode(20);
+                builder.setArgumentPerigee(60);
+                for (std::uint64_t i = 0; i < n; i++)
+                {
+                    builder.setTrueAnomaly((i % INPUTS)*0.35);
+                    keep(builder.build());
+                }
+            };
+        });
+
+        const unsigned int SIZE = 1000000;
+        suite.micro("ephemeris/when/1e6", []()
+        {
+            auto ephemeris = std::make_shared<Ephemeris>(sampledOrbit(SIZE));
+            auto queries = std::make_shared<std::vector<double>>(times(0, (SIZE - 1)*10.0));
+            return [ephemeris, queries](std::uint64_t n)
+            {
+                for (std::uint64_t i = 0; i < n; i++)
+                    keep(ephemeris->when((*queries)[i % INPUTS]));
+            };
+        });
+
+        suite.micro("ephemeris/interpolate/1e6", []()
+        {
+            auto ephemeris = std::make_shared<Ephemeris>(sampledOrbit(SIZE));
+            auto queries = std::make_shared<std::vector<double>>(times(0, (SIZE - 1)*10.0));
+            return [ephemeris, queries](std::uint64_t n)
+            {
+                for (std::uint64_t i = 0; i < n; i++)
+                    keep(ephemeris->interpolate((*queries)[i % INPUTS]));
+            };
+        });
+
+        // Entries later than every stored one, as a propagation adds them
+        suite.micro("ephemeris/include/append", []()
+        {
+            return [](std::uint64_t n)
+            {
+                Ephemeris ephemeris;
+                for (std::uint64_t i = 0; i < n; i++)
+                    ephemeris.include(circularOrbit(i*10.0));
+                keep(ephemeris.size());
+            };
+        });
+
+        // Entries between stored ones of an ephemeris of 1e5 entries
+        suite.micro("ephemeris/include/insert/1e5", []()
+        {
+            auto ephemeris = std::make_shared<Ephemeris>(sampledOrbit(100000));
+            auto queries = std::make_shared<std::vector<double>>(times(0, 99999*10.0));
+            return [ephemeris, queries](std::uint64_t n)
+            {
+                Ephemeris copy{*ephemeris};
+                for (std::uint64_t i = 0; i < n; i++)
+                    copy.include(circularOrbit((*queries)[i % INPUTS] + i*1e-6));
+                keep(copy.size());
+            };
+        });
+
+        suite.micro("chebyshev_ephemeris/at", []()
+        {
+            // One day of LEO every 10 s within a meter
+            auto compressed = std::make_shared<ChebyshevEphemeris>(ChebyshevEphemeris::compress(sampledOrbit(8640), 1e-3));
+            auto queries = std::make_shared<std::vector<double>>(times(0, 8639*10.0));
+            return [compressed, queries](std::uint64_t n)
+            {
+                for (std::uint64_t i = 0; i < n; i++)
+                    keep(compressed->at((*queries)[i % INPUTS]));
+            };
+        });
+    }
+}
+
+void addMicroBenchmarks(BenchmarkSuite& suite)
+{
+    addVectorBenchmarks(suite);
+    addGravityBenchmarks(suite);
+    addEphemerisBenchmarks(suite);
+}
@@ -0,0 +1,127 @@
+#ifndef BATCHKERNELS_HPP
+#define BATCHKERNELS_HPP
+
+#include <cstddef>
+
+/** Positions and velocities of many objects stored by columns.
+ *  Object i is (x[i], y[i], z[i], vx[i], vy[i], vz[i]).
+ */
+struct BatchStateView
+{
+    double *x, *y, *z, *vx, *vy, *vz;
+    std::size_t count;
+
+    /// @return view of the objects from index @param first onwards
+    BatchStateView from(std::size_t first) const
+    {
+        return {x + first, y + first, z + first, vx + first, vy + first, vz + first, count - first};
+    };
+};
+
+/// Central body and integration parameters shared by all the objects of a batch
+struct BatchKernelParams
+{
+    double mu, J2, J3; // J2, J3 as stored in CelestialBody: mu*Jn*R^n
+    bool hasJ2, hasJ3;
+    double dt;
+    unsigned long steps;
+};
+
+/** Leapfrog kernels. Each advances every object of @param state by
+ *  params.steps steps of params.dt, processing as many objects at once
+ *  as its vector width allows.
+ *  @return number of objects propagated, from the first one. Objects past
+ *  the last full vector are left for leapfrogScalar.
+ */
+std::size_t leapfrogScalar(BatchStateView state, const BatchKernelParams& params);
+std::size_t leapfrogAvx2(BatchStateView state, const BatchKernelParams& params);
+std::size_t leapfrogAvx512(BatchStateView state, const BatchKernelParams& params);
+
+/** Acceleration of two-body plus J2/J3 gravity, written once for any Pack
+ *  type: a group of Pack::WIDTH doubles supporting +, -, *, / and sqrt.
+ *  Same physics as zonalAcceleration in GravityModel.hpp.
+ */
+template <typename Pack, bool J2, bool J3>
+void batchAcceleration(const Pack& x, const Pack& y, const Pack& z, const BatchKernelParams& p,
+                       Pack& ax, Pack& ay, Pack& az)
+{
+    Pack r2 = x*x + y*y + z*z;
+    Pack invR2 = Pack(1)/r2;
+    Pack invR3 = invR2*sqrt(invR2);
+
+    Pack k = Pack(-p.mu)*invR3;
+    ax = k*x;
+    ay = k*y;
+    az = k*z;
+
+    if (!J2 && !J3) return;
+
+    Pack invR5 = invR3*invR2;
+    Pack z2r2 = z*z*invR2;
+
+    if (J2)
+    {
+        Pack c = Pack(-1.5*p.J2)*invR5;
+        Pack xy = c*(Pack(1) - Pack(5)*z2r2);
+        ax = ax + xy*x;
+        ay = ay + xy*y;
+        az = az + c*z*(Pack(3) - Pack(5)*z2r2);
+    }
+
+    if (J3)
+    {
+        Pack c = Pack(-2.5*p.J3)*invR5*invR2;
+        Pack xy = c*z*(Pack(3) - Pack(7)*z2r2);
+        ax = ax + xy*x;
+        ay = ay + xy*y;
+        az = az + c*(z*z*(Pack(6) - Pack(7)*z2r2) - Pack(0.6)*r2);
+    }
+}
+
+/// Leapfrog over every full group of Pack::WIDTH objects, each group kept in registers for all steps
+template <typename Pack, bool J2, bool J3>
+std::size_t batchLeapfrog(BatchStateView s, const BatchKernelParams& p)
+{
+    const std::size_t blocks = s.count / Pack::WIDTH;
+    const Pack dt(p.dt), halfDt2(p.dt*p.dt/2), halfDt(p.dt/2);
+
+    for (std::size_t b = 0; b < blocks; b++)
+    {
+        const std::size_t o = b*Pack::WIDTH;
+        Pack x = Pack::load(s.x + o), y = Pack::load(s.y + o), z = Pack::load(s.z + o);
+        Pack vx = Pack::load(s.vx + o), vy = Pack::load(s.vy + o), vz = Pack::load(s.vz + o);
+        Pack ax, ay, az, ax1, ay1, az1;
+        batchAcceleration<Pack, J2, J3>(x, y, z, p, ax, ay, az);
+
+        for (unsigned long i = 0; i < p.steps; i++)
+        {
+            x = x + vx*dt + ax*halfDt2;
+            y = y + vy*dt + ay*halfDt2;
+            z = z + vz*dt + az*halfDt2;
+            batchAcceleration<Pack, J2, J3>(x, y, z, p, ax1, ay1, az1);
+            vx = vx + (ax + ax1)*halfDt;
+            vy = vy + (ay + ay1)*halfDt;
+            vz = vz + (az + az1)*halfDt;
+            ax = ax1;
+            ay = ay1;
+            az = az1;
+        }
+
+        x.store(s.x + o); y.store(s.y + o); z.store(s.z + o);
+        vx.store(s.vx + o); vy.store(s.vy + o); vz.store(s.vz + o);
+    }
+
+    return blocks*Pack::WIDTH;
+}
+
+/// Chooses the instantiation of batchLeapfrog for the zonal terms that are set
+template <typename Pack>
+std::size_t batchLeapfrogDispatch(BatchStateView s, const BatchKernelParams& p)
+{
+    if (p.hasJ2 && p.hasJ3) return batchLeapfrog<Pack, true, true>(s, p);
+    if (p.hasJ2) return batchLeapfrog<Pack, true, false>(s, p);
+    if (p.hasJ3) return batchLeapfrog<Pack, false, true>(s, p);
+    return batchLeapfrog<Pack, false, false>(s, p);
+}
+
+#endif
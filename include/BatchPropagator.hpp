@@ -0,0 +1,72 @@
+#ifndef BATCHPROPAGATOR_HPP
+#define BATCHPROPAGATOR_HPP
+
+#include <istream>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "CelestialBody.hpp"
+#include "Ephemeris.hpp"
+#include "ThirdBody.hpp"
+
+/** Propagates many objects around the same central body at once with the
+ *  Leapfrog method. States are stored by columns and advanced together with
+ *  the widest SIMD kernel the processor supports (AVX-512, AVX2 or scalar).
+ *  Only the current state of each object is kept, not its whole Ephemeris.
+ */
+class BatchPropagator
+{
+    public:
+    /// Adds an object with the position and velocity of @param initial
+    void add(const EphemerisEntry& initial);
+
+    /** Adds one object per line of @param is, each with "x y z vx vy vz"
+     *  in km and km/s. Empty lines are ignored.
+     *  @return number of objects read
+     *  @throw std::invalid_argument if a line is not 6 numbers. Objects
+     *  read up to that line are kept.
+     */
+    unsigned int load(std::istream& is);
+
+    /// Removes all objects
+    void clear();
+
+    /// @return number of objects
+    unsigned int size() const;
+
+    /** Propagates every object from its current state with the Leapfrog method,
+     *  around @param centralBody perturbed by @param perturbers
+     *  @return 0 if no error happened during computation
+     *  @return 1 if there are no objects
+     *  @return 2 if centralBody still has default parameter == 0
+     *  @return 3 if final time and time set are set so that t >= (tf - dt)
+     *  @return 4 if centralBody has a gravity field, which the kernels do not evaluate
+     *  @return 5 if there are perturbers, which the kernels do not evaluate
+     */
+    int propagate(const CelestialBody& centralBody, const Perturbers& perturbers, double tf, double dt);
+
+    /// @return an user friendly message corresponding to exit code in propagate
+    std::string getExitMessage(int code);
+
+    /** @return current state of object @param n
+     *  @throw std::out_of_range If @param n is an invalid index.
+     */
+    EphemerisEntry at(unsigned int n) const;
+
+    /// Outputs to @param os the current state of every object, one per line
+    std::ostream& output(std::ostream& os) const;
+
+    /// @return name of the kernel used on this processor
+    static std::string getKernelName();
+
+    /// @return object-steps per second achieved by the last propagate
+    double getThroughput() const;
+
+    private:
+    std::vector<double> x, y, z, vx, vy, vz;
+    double t{0};
+    double throughput{0};
+};
+
+#endif
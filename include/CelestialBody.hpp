@@ -1,8 +1,11 @@
 #ifndef CELESTIALBODY_HPP
 #define CELESTIALBODY_HPP
 
+#include <memory>
 #include <vector>
 
+class GravityField;
+
 /**
  * Represents a celestial body (planet, asteroid...) that can exert gravitational influence on another body.
  */
@@ -30,9 +33,33 @@ class CelestialBody
     /// @return true iff the n constant has been set
     bool isJefferyConstantSet(unsigned int n) const;
 
+    /** Sets the spherical harmonics @param field of the body, evaluated up to
+     *  degree @param degree and order @param order. While a field is set,
+     *  it replaces the Jeffery constants in numerical propagators.
+     *  @throw std::invalid_argument if the field has no such degree or order > degree
+     */
+    void setGravityField(std::shared_ptr<const GravityField> field, unsigned int degree, unsigned int order);
+
+    /** Changes the degree and order to which the field is evaluated in the next propagations
+     *  @throw std::invalid_argument if there is no field, it has no such degree or order > degree
+     */
+    void setGravityFieldTruncation(unsigned int degree, unsigned int order);
+
+    /// Removes the spherical harmonics field, so Jeffery constants are used again
+    void clearGravityField();
+
+    /// @return spherical harmonics field of the body, nullptr if there is none
+    const std::shared_ptr<const GravityField>& getGravityField() const;
+    /// @return degree to which the field is evaluated
+    unsigned int getGravityFieldDegree() const;
+    /// @return order to which the field is evaluated
+    unsigned int getGravityFieldOrder() const;
+
     private:
     double mu{0}; // Gravitational constant (km^3/s^2)
     std::vector<double> J; // Jeffery's constants in units of km^(n+3)*s^−2
+    std::shared_ptr<const GravityField> field; // Shared between copies, never modified
+    unsigned int fieldDegree{0}, fieldOrder{0};
 };
 
 #endif
\ No newline at end of file
@@ -0,0 +1,33 @@
+#ifndef CHEBYSHEV_HPP
+#define CHEBYSHEV_HPP
+
+/** @return sum of @param c[k]*T_k(@param x) for k < @param n, with x in [-1, 1],
+ *  by the Clenshaw recurrence. @param n must be at least 1.
+ */
+inline double chebyshev(const double* c, unsigned int n, double x)
+{
+    const double x2 = 2*x;
+    double b1{0}, b2{0};
+    for (unsigned int k = n - 1; k > 0; k--)
+    {
+        const double b0 = c[k] + x2*b1 - b2;
+        b2 = b1;
+        b1 = b0;
+    }
+    return c[0] + x*b1 - b2;
+}
+
+/// @return node @param j of the @param n Chebyshev nodes in [-1, 1], from 1 down to -1
+double chebyshevNode(unsigned int j, unsigned int n);
+
+/** Computes in @param c the @param n coefficients of the polynomial that
+ *  interpolates @param values, taken at chebyshevNode(j, n) for j < n
+ */
+void chebyshevFit(const double* values, unsigned int n, double* c);
+
+/** Computes in @param d the @param n coefficients of the derivative with
+ *  respect to x of the series with coefficients @param c. The last one is 0.
+ */
+void chebyshevDerivative(const double* c, unsigned int n, double* d);
+
+#endif
@@ -0,0 +1,130 @@
+#ifndef CHEBYSHEVEPHEMERIS_HPP
+#define CHEBYSHEVEPHEMERIS_HPP
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "Ephemeris.hpp"
+#include "FixedVector.hpp"
+
+/** Header of a Chebyshev ephemeris file. It is followed by segments + 1
+ *  segment bounds and then by the coefficients of each segment: those of x,
+ *  then y, then z. Values are stored in the byte order of the machine that
+ *  wrote the file.
+ */
+struct ChebyshevEphemerisHeader
+{
+    char magic[8];
+    std::uint32_t version;
+    /// EphemerisFile::BYTE_ORDER_MARK as written by the machine that created the file
+    std::uint32_t byteOrder;
+    std::uint32_t coefficients;
+    std::uint32_t reserved;
+    std::uint64_t segments;
+    /// Entries of the compressed ephemeris, evenly spaced by step seconds
+    std::uint64_t count;
+    /// Maximum position error at the compressed entries in km
+    double tolerance;
+    /// Maximum velocity error at the compressed entries in km/s, measured when compressing
+    double velocityError;
+    double step;
+    /// Checksum of the bounds and coefficients
+    std::uint64_t checksum;
+};
+
+/** Trajectory stored as piecewise Chebyshev polynomials of position, fitted
+ *  to an Ephemeris after propagation. Segments adapt their length to the
+ *  trajectory: the same tolerance needs short segments around the periapsis
+ *  of an eccentric orbit and long ones elsewhere. Velocity is the derivative
+ *  of the position polynomials.
+ *
+ *  Segments are found through a lookup table of segments by time, with up to
+ *  8 buckets per segment, then a binary search among the segments of the
+ *  bucket. Any state costs O(1) to evaluate while the shortest segment is at
+ *  least 1/8 of the mean, and O(log n) in the n segments of a bucket when it
+ *  is shorter; then six Clenshaw recurrences run side by side.
+ *  Evaluations do not modify the object and can run in several threads.
+ */
+class ChebyshevEphemeris : public AnalyticTrajectory
+{
+    public:
+    static constexpr char MAGIC[8] = {'O', 'R', 'B', 'C', 'H', 'E', 'B', 'Y'};
+    static constexpr std::uint32_t VERSION = 2;
+    static constexpr unsigned int DEFAULT_COEFFICIENTS = 14;
+
+    /** Fits @param ephemeris with @param coefficients coefficients per coordinate
+     *  and segment. Each segment spans as many entries as possible while the
+     *  position error at all of them stays within @param tolerance km. Values
+     *  between entries come from Ephemeris::interpolate. Velocity is not
+     *  bounded, since propagated velocities need not be the exact derivative
+     *  of positions: its maximum error at the entries is measured instead.
+     *  @throw std::invalid_argument if the ephemeris has less than 2 entries,
+     *  tolerance is not positive or coefficients is less than 4, too few to
+     *  reproduce the cubic interpolation between two entries
+     */
+    static ChebyshevEphemeris compress(const Ephemeris& ephemeris, double tolerance,
+                                       unsigned int coefficients = DEFAULT_COEFFICIENTS);
+
+    /** Reads the file @param path written by write
+     *  @throw std::invalid_argument if the file cannot be read, is not a
+     *  Chebyshev ephemeris file of this version and byte order, or fails the checksum
+     */
+    static ChebyshevEphemeris read(const std::string& path);
+
+    /** Writes the segments to the file @param path
+     *  @throw std::invalid_argument if the file cannot be written
+     */
+    void write(const std::string& path) const;
+
+    /** @return state at time @param t
+     *  @throw std::out_of_range if @param t is outside the segments
+     */
+    EphemerisEntry at(double t) const override;
+
+    double getStart() const;
+    double getEnd() const;
+    unsigned int getSegments() const;
+    unsigned int getCoefficients() const;
+    double getTolerance() const;
+    /// @return maximum velocity error in km/s at the entries of the compressed ephemeris
+    double getVelocityError() const;
+
+    /// @return time between the entries of the compressed ephemeris
+    double getStep() const;
+    /// @return number of entries of the compressed ephemeris
+    unsigned int getCount() const;
+
+    /// @return size in bytes of the file written by write
+    std::uint64_t fileSize() const;
+
+    /** @return analytic Ephemeris with the entries of the compressed one,
+     *  computed on demand from @param trajectory
+     */
+    static Ephemeris toEphemeris(std::shared_ptr<const ChebyshevEphemeris> trajectory);
+
+    private:
+    /// Segments between @param bounds with position @param data, 3*coefficients per segment
+    ChebyshevEphemeris(std::vector<double> bounds, const std::vector<double>& data, unsigned int coefficients,
+                       double tolerance, double step, unsigned int count);
+
+    /// @return segment that contains time @param t, which is within the segments
+    unsigned int segment(double t) const;
+
+    /// @return normalized time of @param t in @param segment
+    double normalized(unsigned int segment, double t) const;
+
+    std::vector<double> bounds;
+    /// Per segment and degree: coefficients of x, y, z and of their derivatives in km/s
+    std::vector<double> data;
+    unsigned int coefficients;
+    double tolerance, step;
+    unsigned int count;
+    double velocityError{0};
+
+    /// First segment of each bucket of bucketWidth seconds from the start
+    std::vector<unsigned int> buckets;
+    double bucketWidth;
+};
+
+#endif
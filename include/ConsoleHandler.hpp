@@ -6,6 +6,7 @@
 #include <vector>
 #include <functional>
 #include <map>
+#include <stdexcept>
 
 #include "Enviroment.hpp"
 
@@ -23,14 +24,14 @@ class CommArgument
     /** Return value stored in the argument as a String.
      *  @throw std::invalid_argument if getType() != STRING
      */
-    std::string getString();
+    std::string getString() const;
 
     /** Return value stored in the argument as a double.
      *  @throw std::invalid_argument if getType() != NUMBER
      */
-    double getNumber();
+    double getNumber() const;
 
-    CommArgType getType();
+    CommArgType getType() const;
 
     private:
     CommArgType type;
@@ -38,6 +39,15 @@ class CommArgument
     double inputNumber;
 };
 
+/** Thrown by the function of a Command that cannot do what it was asked,
+ *  with the message for the user
+ */
+class CommandError : public std::runtime_error
+{
+    public:
+    using std::runtime_error::runtime_error;
+};
+
 class Command
 {
     public:
@@ -50,19 +60,21 @@ class Command
             std::function<std::string (Enviroment&, std::vector<CommArgument>)> function);
 
     /// @return The non-argument part of the command
-    std::string getCommand();
+    const std::string& getCommand() const;
 
     /// @return The argument types that are accepted in order of specification
-    std::vector<CommArgType> getArgumentTypes();
+    const std::vector<CommArgType>& getArgumentTypes() const;
 
     /// @return A brief description of the command functionality
-    std::string getHelp();
+    const std::string& getHelp() const;
 
     /// @return A user friendly representation of the correct usage of the command
-    std::string getUsage();
+    std::string getUsage() const;
 
-    /// @return Calls the actual function in the given enviroment with passed arguments
-    std::string call(Enviroment& env, std::vector<CommArgument> arguments);
+    /** @return Calls the actual function in the given enviroment with passed arguments
+     *  @throw CommandError if the command fails
+     */
+    std::string call(Enviroment& env, std::vector<CommArgument> arguments) const;
 
     private:
     std::string command;
@@ -78,10 +90,47 @@ class ConsoleHandler
     public:
     ConsoleHandler(Enviroment& env, std::istream& input, std::ostream& output);
 
-    /// Start infinite loop where user is asked for commands
+    /// Asks the user for commands until "exit" or the end of the input
     void startQuery();
 
+    /** Runs the scenario files @param paths one after another on the same
+     *  enviroment, without prompts. Every line of every file is read and checked
+     *  first, and nothing runs unless all of them are commands with the right
+     *  arguments, where every number is read entirely. Empty lines and lines starting with '#' are skipped. Execution
+     *  stops at the first command that fails or at "exit". Each result is
+     *  written to the output; errors are prefixed with their file and line.
+     *  @return SCRIPT_SUCCESS or the SCRIPT_* code of the first problem
+     */
+    int runScripts(const std::vector<std::string>& paths);
+
+    /// Exit codes of runScripts
+    static constexpr int SCRIPT_SUCCESS = 0, SCRIPT_COMMAND_FAILED = 1, SCRIPT_INVALID = 2, SCRIPT_UNREADABLE = 3;
+
     private:
+    /// Line of input split into the name of a command and its arguments
+    struct ParsedLine
+    {
+        std::string command;
+        std::vector<CommArgument> arguments;
+        bool help{false}, exit{false};
+        /// First argument that starts like a number but is not entirely one, such as "10s"
+        std::string invalidNumber;
+    };
+
+    /** @return @param line split into words, of which those between quotes are strings.
+     *  Words that start like a number are numbers as far as they can be read.
+     */
+    static ParsedLine parse(const std::string& line);
+
+    /** @return command named @param name that takes @param arguments
+     *  @throw std::out_of_range if there is no such command
+     *  @throw std::invalid_argument with the usage of the command if the arguments do not match
+     */
+    const Command& find(const std::string& name, const std::vector<CommArgument>& arguments) const;
+
+    /// Writes to the output the help of @param name, or the list of commands if empty or unknown
+    void printHelp(const std::string& name);
+
     void emplace(std::string command, vector<CommArgType> argTypes, std::string help, 
         std::function<std::string (Enviroment&, std::vector<CommArgument>)> function);
 
@@ -0,0 +1,85 @@
+#ifndef ENSEMBLE_HPP
+#define ENSEMBLE_HPP
+
+#include <istream>
+#include <memory>
+#include <ostream>
+#include <vector>
+
+#include "CelestialBody.hpp"
+#include "Ephemeris.hpp"
+#include "Propagator.hpp"
+#include "ThirdBody.hpp"
+#include "WorkStealingPool.hpp"
+
+/** Set of independent initial conditions, each with its own final time and
+ *  time step, that are propagated in parallel around the same central body.
+ *  Every member is propagated in its own Enviroment through the Propagator
+ *  interface and keeps its own Ephemeris.
+ */
+class Ensemble
+{
+    public:
+    /** Adds a member starting at @param initial propagated until @param tf with step @param dt
+     *  @throw std::invalid_argument if @param dt is not positive or @param tf
+     *  is not after the time of @param initial, or either is not finite
+     */
+    void add(const EphemerisEntry& initial, double tf, double dt);
+
+    /** Adds one member per line of @param is, each with "x y z vx vy vz tf dt"
+     *  in km, km/s and s. Empty lines are ignored.
+     *  @return number of members read
+     *  @throw std::invalid_argument if a line is not 8 numbers or not a valid
+     *  member for add. Members read up to that line are kept.
+     */
+    unsigned int load(std::istream& is);
+
+    /// Removes all members and their results
+    void clear();
+
+    /// @return number of members
+    unsigned int size() const;
+
+    /** Propagates every member around @param centralBody, perturbed by
+     *  @param perturbers, with a copy of @param propagator using
+     *  @param threads threads, or one per hardware thread if 0. Each member
+     *  keeps entries every @param outputStep seconds, as set with
+     *  Enviroment::setOutputStep with @param outputInterpolated.
+     *  Members whose settings are not valid, or not covered by the tables
+     *  of the perturbers, fail with exit code -1.
+     *  @return number of members whose propagation failed
+     */
+    unsigned int propagate(const CelestialBody& centralBody, const Perturbers& perturbers,
+                           const Propagator& propagator, double outputStep, bool outputInterpolated,
+                           unsigned int threads);
+
+    /** @return exit code of the last propagation of member @param n
+     *  @throw std::out_of_range If @param n is an invalid index.
+     */
+    int getExitCode(unsigned int n) const;
+
+    /** @return Ephemeris computed for member @param n
+     *  @throw std::out_of_range If @param n is an invalid index.
+     */
+    const Ephemeris& getEphemeris(unsigned int n) const;
+
+    /** Outputs to @param os the last entry of every member, one per line
+     *  in the same order they were added. Members not propagated yet output
+     *  their initial entry.
+     */
+    std::ostream& output(std::ostream& os) const;
+
+    private:
+    struct Member
+    {
+        EphemerisEntry initial;
+        double tf, dt;
+        int code;
+        Ephemeris ephemeris;
+    };
+
+    std::vector<Member> members;
+    std::unique_ptr<WorkStealingPool> pool;
+};
+
+#endif
@@ -2,11 +2,18 @@
 #define ENVIROMENT_HPP
 
 #include <memory>
+#include <string>
 
+#include "BatchPropagator.hpp"
 #include "CelestialBody.hpp"
+#include "Ensemble.hpp"
 #include "Ephemeris.hpp"
-#include "MVector.hpp"
+#include "FixedVector.hpp"
+#include "GravityModel.hpp"
+#include "PropagationStats.hpp"
 #include "Propagator.hpp"
+#include "ThirdBody.hpp"
+#include "TextExporter.hpp"
 
 /** Stores the enviroment central CelestialBody, orbiting body's  Ephemeris, a Propagator 
  * for the Ephemeris, an EphemerisEntryBuilder to aid the creation of the first entry 
@@ -23,12 +30,30 @@ class Enviroment
     double getFinalTime();
     /// Gets time step in seconds
     double getTimeStep();
+    /// Gets spacing of the propagated entries in seconds, 0 if it is the time step
+    double getOutputStep();
+    /// @return true iff entries are interpolated at exact multiples of the output step
+    bool isOutputInterpolated();
     EphemerisEntryBuilder& getEphemerisEntryBuilder();
+    /// Columns and header of CSV and TSV exports
+    TextExportFormat& getTextExportFormat();
     /** Using the returned pointer after the method Enviroment::setPropagator
      *  is called or Enviroment goes out of scope will result in a dangling pointer.
      *  Use with care.
      */
     Propagator* getPropagator();
+    /// Objects propagated together around the central body, independently of the Ephemeris
+    BatchPropagator& getBatchPropagator();
+    /// Independent initial conditions propagated in parallel around the central body
+    Ensemble& getEnsemble();
+    /// Third bodies that perturb the orbit, with the epoch of time 0
+    Perturbers& getPerturbers();
+    /** Counters and timers of the last propagation, which stay at 0 unless
+     *  built with ORBITAL_STATS. Memory of the ephemeris is that after the propagation.
+     */
+    const PropagationStats& getStats();
+    /// File to which the stats of every propagation are appended as JSON lines, empty for none
+    const std::string& getStatsFile();
 
     void setCentralBody(CelestialBody central);
     void setEphemeris(Ephemeris ephemeris);
@@ -36,25 +61,71 @@ class Enviroment
     void setFinalTime(double time);
     /// Sets time step in seconds
     void setTimeStep(double time);
+    /** Keeps one entry every @param time seconds of propagation, 0 to keep every
+     *  time step, interpolating them at exact multiples of it if @param interpolate.
+     *  See ResamplingSink.
+     *  @throw std::invalid_argument if @param time is negative
+     */
+    void setOutputStep(double time, bool interpolate);
     void setPropagator(std::unique_ptr<Propagator>&& propagator);
+    void setStatsFile(std::string path);
 
     /** Get the acceleration the orbiting body suffers in the position
-     *  defined by @param currentPosition, in km/s^2 and stored in a 
-     *  3 size vector
+     *  defined by @param currentPosition, in km/s^2
+     */
+    Vec3 getAcceleration(const EphemerisEntry& currentPosition);
+
+    /** Get the acceleration the orbiting body suffers at time @param t in the
+     *  position @param position in km, in km/s^2
      */
-    MVector getAcceleration(EphemerisEntry currentPosition);
+    Vec3 getAcceleration(double t, const Vec3& position);
 
-    /** Propagates the ephemeris of this Enviroment.
+    /** @return gravity of the central body and third bodies as it is now, with
+     *  its kernel already chosen. Propagators get it once per propagation.
+     */
+    GravityModel getGravityModel();
+
+    /** Propagates the ephemeris of this Enviroment, keeping entries every output step.
      *  @return the exit code of the propagator
+     *  @throw std::out_of_range if the tables of the third bodies do not cover the propagation
+     *  @throw std::runtime_error if the stats file is set and cannot be written
      */
     int propagate();
 
+    /** Propagates from the initial entry of this Enviroment to @param sink,
+     *  every output step, without storing the entries in the ephemeris
+     *  @return the exit code of the propagator
+     *  @throw std::out_of_range if the tables of the third bodies do not cover the propagation
+     *  @throw std::runtime_error if the stats file is set and cannot be written
+     */
+    int propagate(EphemerisSink& sink);
+
     private:
+    /// @throw std::out_of_range if the tables of the third bodies do not cover the propagation
+    void checkPerturbers();
+
+    /** Checks the perturbers and runs @param propagation, which returns the exit
+     *  code of the propagator, recording the stats of both
+     */
+    template <class Propagation>
+    int record(Propagation propagation);
+
+    /// Appends the stats to the stats file, if set
+    void writeStats();
+
     CelestialBody centralBody;
     Ephemeris ephemeris{};
     EphemerisEntryBuilder builder{};
+    TextExportFormat exportFormat{};
     std::unique_ptr<Propagator> propagator{new LeapfrogPropagator()};
+    BatchPropagator batch{};
+    Ensemble ensemble{};
+    Perturbers perturbers{};
     double tf{0}, dt{0};
+    double outputStep{0};
+    bool outputInterpolated{false};
+    PropagationStats stats{};
+    std::string statsFile{};
 };
 
 #endif
\ No newline at end of file
@@ -2,7 +2,11 @@
 #define EPHEMERIS_HPP
 
 #include "CelestialBody.hpp"
+#include "FixedVector.hpp"
+#include "Span.hpp"
+#include "EphemerisChunk.hpp"
 #include <vector>
+#include <memory>
 #include <experimental/optional>
 
 using std::vector;
@@ -10,8 +14,27 @@ using std::experimental::optional;
 
 class EphemerisEntry;
 
+/// Trajectory known in closed form, whose state can be computed at any time
+class AnalyticTrajectory
+{
+    public:
+    /// @return state of the trajectory at time @param t
+    virtual EphemerisEntry at(double t) const = 0;
+
+    virtual ~AnalyticTrajectory() {};
+};
+
+/// Columns in which Ephemeris stores its data
+enum class EphemerisColumn {T, X, Y, Z, VX, VY, VZ};
+
 /**
  * Represents a series of EphemerisEntrys that are in strict temporal order.
+ * Data is stored in fixed size EphemerisChunks, each holding one contiguous
+ * array per coordinate and time, so consumers only touch the columns they need.
+ * Appending never relocates stored entries and copies of an Ephemeris share
+ * its chunks until one of them modifies a chunk.
+ * An Ephemeris can also be analytic: entries after the first one are then
+ * computed on demand from an AnalyticTrajectory instead of being stored.
  * Implements move semantics.
  */
 class Ephemeris
@@ -25,21 +48,55 @@ class Ephemeris
     Ephemeris& operator=(Ephemeris&& source);
 
     /// @return the number of EphemerisEntrys
-    unsigned int size();
+    unsigned int size() const;
 
-    /** @return Read/write reference to entry.
+    /** @return Copy of entry at index @param n.
      *  @throw std::out_of_range If @param n is an invalid index.
      */
-    EphemerisEntry& at(unsigned int n);
+    EphemerisEntry at(unsigned int n) const;
 
     /** @return EphemerisEntry that represents a moment in time
-     * closest to the given time @param t
-     * @throw std::out_of_range If ephemeris is empty
+     * closest to the given time @param t. Found by binary search.
+     * @throw std::invalid_argument If ephemeris has less than 2 entries
+     */
+    EphemerisEntry when(double t) const;
+
+    /** @return EphemerisEntry at exactly time @param t, computed by cubic
+     * Hermite interpolation of position and velocity of the surrounding entries.
+     * @throw std::invalid_argument If ephemeris has less than 2 entries
+     * @throw std::out_of_range If @param t is outside the time span of the ephemeris
+     */
+    EphemerisEntry interpolate(double t) const;
+
+    /** Answers many time queries at once. Queries are sorted and then answered
+     *  in a single walk over the ephemeris, so the cost is O(k log k + n) instead
+     *  of O(k log n). @param results receives, in the same order as @param queryTimes,
+     *  the closest EphemerisEntry to each time, or the interpolated one if
+     *  @param interpolate is true.
+     *  @throw std::invalid_argument If sizes of queryTimes and results differ or
+     *  ephemeris has less than 2 entries
+     *  @throw std::out_of_range If interpolating and a time is outside the ephemeris
      */
-    EphemerisEntry& when(double t);
+    void when(Span<const double> queryTimes, Span<EphemerisEntry> results, bool interpolate) const;
+
+    /// @return the number of EphemerisChunks the entries are stored in
+    unsigned int chunkCount() const;
+
+    /** @return bytes taken by the stored entries. Chunks shared with other
+     *  Ephemeris count in full, read-only ones mapped from files do not.
+     */
+    std::size_t memoryUsage() const;
+
+    /** @return read-only view of column @param c of the entries stored in
+     *  @param chunk. Chunk k holds entries from k*EphemerisChunk::CAPACITY onwards.
+     *  Appending does not invalidate it, any other modification might.
+     *  An analytic ephemeris only stores its first entry: call materialize() first.
+     *  @throw std::out_of_range If @param chunk is an invalid index.
+     */
+    Span<const double> column(EphemerisColumn c, unsigned int chunk) const;
 
     /// @return true iff there are no entries
-    bool empty();
+    bool empty() const;
 
     /**
      * Inserts the @param entry into the Ephemeris at an appropiate position
@@ -47,6 +104,41 @@ class Ephemeris
      */ 
     unsigned int include(EphemerisEntry entry);
 
+    /** Appends @param entry at the end without checking temporal order.
+     *  Only for entries known to be later than every stored one, such as
+     *  the ones generated step by step by a Propagator.
+     */
+    void append(const EphemerisEntry& entry);
+
+    /** Appends all the entries of @param chunk without copying them. The chunk
+     *  is shared, not modified: it is copied before any change to its entries.
+     *  @throw std::invalid_argument If the last stored chunk is not full or the
+     *  entries of @param chunk are not later than the stored ones.
+     */
+    void appendChunk(std::shared_ptr<EphemerisChunk> chunk);
+
+    /** Preallocates space for @param n entries in total, so that adding
+     *  entries up to that amount never allocates.
+     */
+    void reserve(unsigned int n);
+
+    /** Makes the ephemeris analytic: keeps the first entry and replaces the rest
+     *  by @param count entries in total, every @param step seconds from the first
+     *  one, computed on demand from @param trajectory. Lookups then cost O(1)
+     *  and interpolate() returns the exact state of the trajectory.
+     *  @throw std::invalid_argument If the ephemeris is empty
+     */
+    void setAnalytic(std::shared_ptr<const AnalyticTrajectory> trajectory, double step, unsigned int count);
+
+    /// @return true iff entries are computed from an AnalyticTrajectory
+    bool isAnalytic() const;
+
+    /** Computes and stores every entry of an analytic ephemeris, which then
+     *  becomes a regular one. Adding entries or reserving does it implicitly.
+     *  Does nothing if the ephemeris is not analytic.
+     */
+    void materialize();
+
     /// Removes all EphemerisEntry and includes this EphemerisEntry
     void setInitialEntry(EphemerisEntry entry);
 
@@ -63,7 +155,41 @@ class Ephemeris
     std::ostream& output(std::ostream &os, bool verbose);
 
     private:
-    vector<EphemerisEntry> entries;
+    static constexpr unsigned int CHUNK = EphemerisChunk::CAPACITY;
+
+    /// @return value of column @param c of entry @param n
+    double value(EphemerisColumn c, unsigned int n) const;
+    /// @return time of entry @param n
+    double time(unsigned int n) const;
+
+    /// @return chunk @param k, copying it first if it is shared with other Ephemeris
+    EphemerisChunk& writableChunk(unsigned int k);
+
+    /// @return first entry with time >= @param t, or size() if there is none
+    unsigned int lowerBound(double t) const;
+    /// @return first entry with time > @param t, or size() if there is none
+    unsigned int upperBound(double t) const;
+
+    /// @return index of entry closest to @param t, given @param i first entry with time >= t
+    unsigned int closestIndex(unsigned int i, double t) const;
+
+    /// @return n such that entries n and n+1 enclose a time, given @param i first entry with time >= t
+    unsigned int segmentIndex(unsigned int i) const;
+
+    /** @return interpolated EphemerisEntry at time @param t between the entries
+     *  at index @param n and n+1
+     */
+    EphemerisEntry interpolateSegment(unsigned int n, double t) const;
+
+    /// Inserts @param entry before the entry at index @param n
+    void insertAt(unsigned int n, const EphemerisEntry& entry);
+
+    vector<std::shared_ptr<EphemerisChunk>> chunks;
+    unsigned int count{0};
+
+    std::shared_ptr<const AnalyticTrajectory> trajectory;
+    double analyticStep{0};
+    unsigned int analyticCount{0};
 };
 
 /**
@@ -74,6 +200,8 @@ class EphemerisEntry
     public:
     EphemerisEntry(double x, double y, double z, double vx, double vy, double vz, double t)
      : x(x), y(y), z(z), vx(vx), vy(vy), vz(vz), t(t) {};
+    EphemerisEntry(const Vec3& r, const Vec3& v, double t)
+     : EphemerisEntry(r[0], r[1], r[2], v[0], v[1], v[2], t) {};
     EphemerisEntry() : EphemerisEntry(0,0,0,0,0,0,0) {}; 
 
     /// @return x-coordinate of position in km
@@ -91,6 +219,13 @@ class EphemerisEntry
     /// @return reference time in seconds
     double getTime() const;
 
+    /// @return position vector in km
+    Vec3 getPosition() const;
+    /// @return velocity vector in km/s
+    Vec3 getVelocity() const;
+    /// @return position and velocity in km and km/s
+    State6 getState() const;
+
     /** Outputs to @param os the contents of the entry.
      *  @param verbose whether to print in a friendly way or in one line
      */
@@ -100,6 +235,12 @@ class EphemerisEntry
     double x,y,z,vx,vy,vz,t;
 };
 
+/** Cubic Hermite interpolation between two states @param s0 and @param s1
+ *  from their positions and velocities only.
+ *  @return the interpolated state at time @param t
+ */
+EphemerisEntry interpolateCubic(const EphemerisEntry& s0, const EphemerisEntry& s1, double t);
+
 class EphemerisEntryBuilder
 {
     public:
@@ -0,0 +1,95 @@
+#ifndef EPHEMERISCHUNK_HPP
+#define EPHEMERISCHUNK_HPP
+
+#include <memory>
+#include <mutex>
+#include <vector>
+
+/**
+ * Fixed capacity block of consecutive ephemeris entries stored by columns
+ * (t, x, y, z, vx, vy, vz). The memory of a chunk is taken from
+ * EphemerisChunkPool and never moves while the chunk is alive, so appending
+ * to a chunk never relocates the entries already in it.
+ * A chunk can also be external: its columns then point to read-only memory
+ * kept alive by the chunk, such as a mapped file, and must be copied before
+ * being modified.
+ */
+class EphemerisChunk
+{
+    public:
+    /// Number of columns stored
+    static constexpr unsigned int COLUMNS = 7;
+    /// Number of entries a chunk can hold
+    static constexpr unsigned int CAPACITY = 4096;
+
+    /// Creates an empty chunk
+    EphemerisChunk();
+    ~EphemerisChunk();
+    /** Creates an external chunk of @param count entries whose columns start at
+     *  @param columns, in memory that @param storage keeps alive
+     */
+    EphemerisChunk(const double* const columns[COLUMNS], unsigned int count, std::shared_ptr<const void> storage);
+    /// Copies the entries of @param source into new memory
+    EphemerisChunk(const EphemerisChunk& source);
+    EphemerisChunk& operator=(const EphemerisChunk& source) = delete;
+
+    /// @return number of entries in the chunk
+    unsigned int size() const { return count; };
+
+    /// @return true iff no more entries fit in the chunk
+    bool full() const { return count == CAPACITY; };
+
+    /// @return true iff the columns are read-only memory not owned by the chunk
+    bool isExternal() const { return block == nullptr; };
+
+    /// @return pointer to the first element of column @param c
+    double* column(unsigned int c) { return columns[c]; };
+    const double* column(unsigned int c) const { return columns[c]; };
+
+    /// Appends an entry with @param values ordered as the columns. Chunk must not be full
+    void push(const double values[COLUMNS]);
+
+    /// Inserts an entry with @param values before index @param n. Chunk must not be full
+    void insert(unsigned int n, const double values[COLUMNS]);
+
+    /// Removes the last entry, copying its values to @param values
+    void pop(double values[COLUMNS]);
+
+    private:
+    double* block;
+    double* columns[COLUMNS];
+    unsigned int count{0};
+    std::shared_ptr<const void> storage;
+};
+
+/**
+ * Arena of memory blocks for EphemerisChunks. Released blocks are kept
+ * and handed out again, so repeated propagations do not go back to the
+ * system allocator. Thread safe.
+ */
+class EphemerisChunkPool
+{
+    public:
+    /// Number of doubles in each block
+    static constexpr unsigned int BLOCK_SIZE = EphemerisChunk::COLUMNS * EphemerisChunk::CAPACITY;
+    /// Released blocks above this amount are returned to the system
+    static constexpr unsigned int MAX_FREE_BLOCKS = 256;
+
+    /// @return a block of BLOCK_SIZE uninitialized doubles
+    static double* acquire();
+
+    /// Gives back a block obtained through acquire
+    static void release(double* block);
+
+    /// Makes sure at least @param blocks blocks can be acquired without allocating
+    static void reserve(unsigned int blocks);
+
+    /// @return number of released blocks kept to be handed out again
+    static unsigned int freeBlockCount();
+
+    private:
+    static std::mutex mutex;
+    static std::vector<std::unique_ptr<double[]>> freeBlocks;
+};
+
+#endif
@@ -0,0 +1,137 @@
+#ifndef EPHEMERISFILE_HPP
+#define EPHEMERISFILE_HPP
+
+#include <array>
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "CelestialBody.hpp"
+#include "Ephemeris.hpp"
+
+/** Fixed part of the header of a binary ephemeris file. It is followed by
+ *  zonalCount Jeffery constants (J2, J3...) and then by the payload: the
+ *  columns t, x, y, z, vx, vy, vz one after another, count doubles each.
+ *  Values are stored in the byte order of the machine that wrote the file.
+ */
+struct EphemerisFileHeader
+{
+    char magic[8];
+    std::uint32_t version;
+    /// BYTE_ORDER_MARK as written by the machine that created the file
+    std::uint32_t byteOrder;
+    std::uint32_t zonalCount;
+    std::uint32_t reserved;
+    std::uint64_t count;
+    /// Gravitational parameter of the central body in km^3/s^2
+    double mu;
+    /// Time of the first entry and time step of the propagation in seconds
+    double t0, dt;
+    /// Checksum of the payload
+    std::uint64_t checksum;
+};
+
+/** Writes a binary ephemeris file entry by entry, with constant memory.
+ *  Entries are gathered in blocks and each column of a block is written
+ *  to its place in the payload, so the number of entries must be known
+ *  from the start.
+ */
+class EphemerisFileWriter
+{
+    public:
+    static constexpr unsigned int COLUMNS = EphemerisChunk::COLUMNS;
+
+    /** Creates the file @param path for @param count entries propagated around
+     *  @param centralBody with time step @param timeStep
+     *  @throw std::invalid_argument if the file cannot be created
+     */
+    EphemerisFileWriter(const std::string& path, const CelestialBody& centralBody,
+                        double timeStep, unsigned int count);
+
+    /** Writes the next @param entry
+     *  @throw std::out_of_range if more entries than announced are written
+     */
+    void write(const EphemerisEntry& entry);
+
+    /** Writes the next @param n entries, given by pointers to their @param columns
+     *  @throw std::out_of_range if more entries than announced are written
+     */
+    void write(const double* const columns[COLUMNS], unsigned int n);
+
+    /** Completes the file by writing its header. Until then it is not valid.
+     *  If fewer entries than announced were written, as when a propagation
+     *  fails, the columns are moved together and the file holds only those.
+     *  @throw std::invalid_argument if the file could not be written
+     */
+    void close();
+
+    private:
+    /// Writes the buffered entries
+    void flush();
+
+    void writeBlock(const double* const columns[COLUMNS], unsigned int n);
+
+    /// Moves the columns, placed for header.count entries, to their place for the written ones
+    void compact();
+
+    std::string path;
+    std::fstream file;
+    EphemerisFileHeader header{};
+    std::vector<double> zonal;
+    std::streamoff payload;
+    std::uint64_t written{0};
+    std::array<std::uint64_t, COLUMNS> hashes;
+    std::array<std::vector<double>, COLUMNS> buffer;
+    unsigned int buffered{0};
+};
+
+/** Binary ephemeris file. The reader maps the file into memory and the
+ *  resulting Ephemeris points straight into the mapping, so opening a file
+ *  neither parses nor copies the entries. The Ephemeris can be modified as
+ *  any other: the affected chunks are copied first and the file never changes.
+ */
+class EphemerisFile
+{
+    public:
+    static constexpr char MAGIC[8] = {'O', 'R', 'B', 'E', 'P', 'H', 'E', 'M'};
+    static constexpr std::uint32_t VERSION = 1;
+    static constexpr std::uint32_t BYTE_ORDER_MARK = 0x01020304;
+    static constexpr std::uint64_t HASH_OFFSET = 0xcbf29ce484222325ULL;
+
+    /** FNV-1a over 64 bit words, @return hash @param h updated with @param n
+     *  doubles from @param data. Each column is hashed separately so that they
+     *  can be written in any order.
+     */
+    static std::uint64_t hash(std::uint64_t h, const double* data, std::size_t n);
+
+    /** Writes @param ephemeris, propagated around @param centralBody with
+     *  time step @param timeStep, to the file @param path
+     *  @throw std::invalid_argument if the file cannot be written
+     */
+    static void write(const std::string& path, const Ephemeris& ephemeris,
+                      const CelestialBody& centralBody, double timeStep);
+
+    /** Maps the file @param path. If @param verify, the checksum of the payload
+     *  is checked, which reads the whole file once.
+     *  @throw std::invalid_argument if the file cannot be opened, is not an
+     *  ephemeris file of this version and byte order, or fails the checksum
+     */
+    explicit EphemerisFile(const std::string& path, bool verify = true);
+
+    /// @return read-only view of the entries of the file
+    const Ephemeris& getEphemeris() const;
+
+    /// @return central body, with its gravitational parameter and Jeffery constants
+    const CelestialBody& getCentralBody() const;
+
+    /// @return time step of the propagation in seconds
+    double getTimeStep() const;
+
+    private:
+    Ephemeris ephemeris;
+    CelestialBody centralBody;
+    double timeStep{0};
+};
+
+#endif
@@ -0,0 +1,143 @@
+#ifndef EPHEMERISSINK_HPP
+#define EPHEMERISSINK_HPP
+
+#include <fstream>
+#include <functional>
+#include <memory>
+#include <string>
+
+#include "CelestialBody.hpp"
+#include "Ephemeris.hpp"
+
+class EphemerisFileWriter;
+class TextExporter;
+
+/** Destination of the entries computed by a Propagator, which hands them
+ *  over one by one as they are computed. Sinks that do not keep them all,
+ *  such as files, let a propagation run with constant memory.
+ */
+class EphemerisSink
+{
+    public:
+    /** Starts receiving an ephemeris of @param count entries in total,
+     *  the first of which is @param initial
+     */
+    virtual void begin(const EphemerisEntry& initial, unsigned int count) = 0;
+
+    /// Receives the next entry, later than the previous ones
+    virtual void append(const EphemerisEntry& entry) = 0;
+
+    /** Called once the propagator stops appending entries, including when
+     *  it fails after begin. Files then hold the entries computed so far.
+     */
+    virtual void end() {};
+
+    virtual ~EphemerisSink() {};
+};
+
+/// Stores the entries in an Ephemeris, replacing its previous entries
+class MemorySink : public EphemerisSink
+{
+    public:
+    MemorySink(Ephemeris& ephemeris) : ephemeris(ephemeris) {};
+
+    void begin(const EphemerisEntry& initial, unsigned int count) override;
+    void append(const EphemerisEntry& entry) override;
+
+    private:
+    Ephemeris& ephemeris;
+};
+
+/** Passes to another sink only one entry every output step, so that the
+ *  integration step can be much smaller than the spacing of the results.
+ *  Without interpolation, the output step is rounded to a whole number of
+ *  time steps and every so many entries are passed on. With interpolation,
+ *  entries are passed at exactly every output step from the first one,
+ *  interpolated between the surrounding time steps.
+ */
+class ResamplingSink : public EphemerisSink
+{
+    public:
+    /** Passes to @param target the entries every @param outputStep seconds of an
+     *  ephemeris with entries every @param timeStep seconds
+     *  @throw std::invalid_argument if any step is not greater than 0
+     */
+    ResamplingSink(EphemerisSink& target, double timeStep, double outputStep, bool interpolate);
+
+    void begin(const EphemerisEntry& initial, unsigned int count) override;
+    void append(const EphemerisEntry& entry) override;
+    void end() override;
+
+    private:
+    EphemerisSink& target;
+    double timeStep, outputStep;
+    bool interpolate;
+
+    /// Entries between those passed on, without interpolation
+    unsigned int stride{1}, skipped{0};
+    /// Next output epoch is t0 + next*outputStep, with interpolation
+    double t0{0};
+    unsigned int next{0}, remaining{0};
+    EphemerisEntry previous;
+};
+
+/// Passes every entry to a function
+class CallbackSink : public EphemerisSink
+{
+    public:
+    CallbackSink(std::function<void(const EphemerisEntry&)> callback) : callback(std::move(callback)) {};
+
+    void begin(const EphemerisEntry& initial, unsigned int count) override;
+    void append(const EphemerisEntry& entry) override;
+
+    private:
+    std::function<void(const EphemerisEntry&)> callback;
+};
+
+/// Writes the entries to a text file in the format of Ephemeris::output
+class TextFileSink : public EphemerisSink
+{
+    public:
+    /** Creates the file @param path
+     *  @throw std::invalid_argument if the file cannot be created
+     */
+    TextFileSink(const std::string& path);
+    ~TextFileSink();
+
+    void begin(const EphemerisEntry& initial, unsigned int count) override;
+    void append(const EphemerisEntry& entry) override;
+
+    /// @throw std::invalid_argument if the file could not be written
+    void end() override;
+
+    private:
+    std::string path;
+    std::ofstream file;
+    std::unique_ptr<TextExporter> exporter;
+};
+
+/// Writes the entries to a binary ephemeris file, see EphemerisFile
+class BinaryFileSink : public EphemerisSink
+{
+    public:
+    /** The file @param path is created by begin and also stores
+     *  @param centralBody and the time step @param timeStep
+     */
+    BinaryFileSink(const std::string& path, const CelestialBody& centralBody, double timeStep);
+    ~BinaryFileSink();
+
+    /// @throw std::invalid_argument if the file cannot be created
+    void begin(const EphemerisEntry& initial, unsigned int count) override;
+    void append(const EphemerisEntry& entry) override;
+
+    /// @throw std::invalid_argument if the file could not be written
+    void end() override;
+
+    private:
+    std::string path;
+    CelestialBody centralBody;
+    double timeStep;
+    std::unique_ptr<EphemerisFileWriter> writer;
+};
+
+#endif
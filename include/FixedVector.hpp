@@ -0,0 +1,259 @@
+#ifndef FIXEDVECTOR_HPP
+#define FIXEDVECTOR_HPP
+
+#include <cstddef>
+#include <cmath>
+#include <initializer_list>
+#include <stdexcept>
+#include <ostream>
+
+/**
+ *  Represents a vector in the mathematical sense of the word whose size
+ *  is known at compile time. Elements are stored inline so, unlike MVector,
+ *  no operation allocates memory. Meant for the 3 and 6 element vectors
+ *  used during propagation; use MVector for sizes only known at runtime.
+ */
+template <std::size_t N>
+class FixedVector
+{
+    static_assert(N > 0, "Size must be greater than 0");
+
+    public:
+    /// Constructs vector with 0 in all elements
+    constexpr FixedVector() : data{} {};
+
+    /** Constructs vector from the elements of @param list
+     *  @throw std::invalid_argument if the list does not have N elements
+     */
+    constexpr FixedVector(std::initializer_list<double> list);
+
+    /// @return same vector
+    constexpr FixedVector operator+() const;
+
+    /// @return sum of two vectors
+    constexpr FixedVector operator+(const FixedVector& other) const;
+
+    /// @return vector with same magnitudes but opposite sign
+    constexpr FixedVector operator-() const;
+
+    /// @return vector which is this - other elements
+    constexpr FixedVector operator-(const FixedVector& other) const;
+
+    /// @return Dot product of two vectors
+    constexpr double operator*(const FixedVector& other) const;
+
+    /// @return Cross product of two vectors. Only available for N == 3
+    constexpr FixedVector operator%(const FixedVector& other) const;
+
+    /// @return vector multiplied by @param multiplier
+    constexpr FixedVector operator*(double multiplier) const;
+
+    /// @return vector divided by @param divider
+    constexpr FixedVector operator/(double divider) const;
+
+    constexpr FixedVector& operator+=(const FixedVector& other);
+    constexpr FixedVector& operator-=(const FixedVector& other);
+    constexpr FixedVector& operator*=(double multiplier);
+    constexpr FixedVector& operator/=(double divider);
+
+    /// @return true iff all elements are equal
+    constexpr bool operator==(const FixedVector& other) const;
+
+    /// @return false iff all elements are equal
+    constexpr bool operator!=(const FixedVector& other) const;
+
+    /// @return access to number at index @param n. Not bounds checked
+    constexpr double& operator[](std::size_t n);
+    constexpr const double& operator[](std::size_t n) const;
+
+    /// @return squared norm of vector
+    constexpr double squaredNorm() const;
+
+    /// @return norm of vector
+    double norm() const;
+
+    /// @return size of the vector
+    static constexpr std::size_t size() { return N; };
+
+    private:
+    double data[N];
+};
+
+/// Position, velocity or acceleration in cartesian coordinates
+using Vec3 = FixedVector<3>;
+/// Position and velocity in cartesian coordinates: x, y, z, vx, vy, vz
+using State6 = FixedVector<6>;
+
+template <std::size_t N>
+constexpr FixedVector<N>::FixedVector(std::initializer_list<double> list) : data{}
+{
+    if (list.size() != N)
+        throw std::invalid_argument("Initializer list size must coincide with vector size");
+
+    for (std::size_t i = 0; i < N; i++)
+        data[i] = *(list.begin() + i);
+}
+
+template <std::size_t N>
+constexpr FixedVector<N> FixedVector<N>::operator+() const
+{
+    return *this;
+}
+
+template <std::size_t N>
+constexpr FixedVector<N> FixedVector<N>::operator+(const FixedVector& other) const
+{
+    FixedVector result;
+    for (std::size_t i = 0; i < N; i++)
+        result.data[i] = data[i] + other.data[i];
+    return result;
+}
+
+template <std::size_t N>
+constexpr FixedVector<N> FixedVector<N>::operator-() const
+{
+    FixedVector result;
+    for (std::size_t i = 0; i < N; i++)
+        result.data[i] = -data[i];
+    return result;
+}
+
+template <std::size_t N>
+constexpr FixedVector<N> FixedVector<N>::operator-(const FixedVector& other) const
+{
+    FixedVector result;
+    for (std::size_t i = 0; i < N; i++)
+        result.data[i] = data[i] - other.data[i];
+    return result;
+}
+
+template <std::size_t N>
+constexpr double FixedVector<N>::operator*(const FixedVector& other) const
+{
+    double result{0};
+    for (std::size_t i = 0; i < N; i++)
+        result += data[i] * other.data[i];
+    return result;
+}
+
+template <std::size_t N>
+constexpr FixedVector<N> FixedVector<N>::operator%(const FixedVector& other) const
+{
+    static_assert(N == 3, "Cross product is only defined for vectors of size 3");
+
+    FixedVector result;
+    result.data[0] = data[1]*other.data[2] - data[2]*other.data[1];
+    result.data[1] = data[2]*other.data[0] - data[0]*other.data[2];
+    result.data[2] = data[0]*other.data[1] - data[1]*other.data[0];
+    return result;
+}
+
+template <std::size_t N>
+constexpr FixedVector<N> FixedVector<N>::operator*(double multiplier) const
+{
+    FixedVector result;
+    for (std::size_t i = 0; i < N; i++)
+        result.data[i] = data[i] * multiplier;
+    return result;
+}
+
+template <std::size_t N>
+constexpr FixedVector<N> FixedVector<N>::operator/(double divider) const
+{
+    FixedVector result;
+    for (std::size_t i = 0; i < N; i++)
+        result.data[i] = data[i] / divider;
+    return result;
+}
+
+template <std::size_t N>
+constexpr FixedVector<N>& FixedVector<N>::operator+=(const FixedVector& other)
+{
+    for (std::size_t i = 0; i < N; i++)
+        data[i] += other.data[i];
+    return *this;
+}
+
+template <std::size_t N>
+constexpr FixedVector<N>& FixedVector<N>::operator-=(const FixedVector& other)
+{
+    for (std::size_t i = 0; i < N; i++)
+        data[i] -= other.data[i];
+    return *this;
+}
+
+template <std::size_t N>
+constexpr FixedVector<N>& FixedVector<N>::operator*=(double multiplier)
+{
+    for (std::size_t i = 0; i < N; i++)
+        data[i] *= multiplier;
+    return *this;
+}
+
+template <std::size_t N>
+constexpr FixedVector<N>& FixedVector<N>::operator/=(double divider)
+{
+    for (std::size_t i = 0; i < N; i++)
+        data[i] /= divider;
+    return *this;
+}
+
+template <std::size_t N>
+constexpr bool FixedVector<N>::operator==(const FixedVector& other) const
+{
+    for (std::size_t i = 0; i < N; i++)
+        if (data[i] != other.data[i]) return false;
+    return true;
+}
+
+template <std::size_t N>
+constexpr bool FixedVector<N>::operator!=(const FixedVector& other) const
+{
+    return !(*this == other);
+}
+
+template <std::size_t N>
+constexpr double& FixedVector<N>::operator[](std::size_t n)
+{
+    return data[n];
+}
+
+template <std::size_t N>
+constexpr const double& FixedVector<N>::operator[](std::size_t n) const
+{
+    return data[n];
+}
+
+template <std::size_t N>
+constexpr double FixedVector<N>::squaredNorm() const
+{
+    return (*this) * (*this);
+}
+
+template <std::size_t N>
+double FixedVector<N>::norm() const
+{
+    return std::sqrt(squaredNorm());
+}
+
+/// @return vector @param v multiplied by @param multiplier
+template <std::size_t N>
+constexpr FixedVector<N> operator*(double multiplier, const FixedVector<N>& v)
+{
+    return v*multiplier;
+}
+
+template <std::size_t N>
+std::ostream &operator<<(std::ostream &os, const FixedVector<N> &v)
+{
+    for (std::size_t i = 0; i < N; i++)
+    {
+        os << v[i];
+        if (i != N - 1)
+            os << ",";
+    }
+
+    return os;
+}
+
+#endif
@@ -0,0 +1,109 @@
+#ifndef GRAVITYFIELD_HPP
+#define GRAVITYFIELD_HPP
+
+#include <istream>
+#include <memory>
+#include <vector>
+
+#include "FixedVector.hpp"
+
+/** Spherical harmonics expansion of the gravity potential of a body,
+ *  with fully normalized coefficients Cnm, Snm:
+ *  U = GM/r * sum_n (R/r)^n sum_m Pnm(sin(lat)) * (Cnm*cos(m*lon) + Snm*sin(m*lon))
+ */
+class GravityField
+{
+    public:
+    /** Field of degree and order @param maxDegree with all coefficients 0,
+     *  of a body with gravitational parameter @param mu in km^3/s^2 and
+     *  reference radius @param radius in km
+     *  @throw std::invalid_argument if @param mu or @param radius are not positive
+     */
+    GravityField(double mu, double radius, unsigned int maxDegree);
+
+    /** Reads a field in the ICGEM format (.gfc files): a header up to the
+     *  line "end_of_head" with at least earth_gravity_constant in m^3/s^2
+     *  and radius in m, then one "gfc n m C S [sigmaC sigmaS]" line per
+     *  coefficient. Missing coefficients are 0 and Fortran exponents
+     *  (1.0D-06) are accepted.
+     *  @throw std::invalid_argument if the header or a line is not valid,
+     *  or the coefficients are not fully normalized
+     */
+    static GravityField read(std::istream& is);
+
+    /// @return gravitational parameter the coefficients refer to in km^3/s^2
+    double getGravitationalParameter() const;
+    /// @return reference radius of the coefficients in km
+    double getRadius() const;
+    /// @return highest degree with coefficients
+    unsigned int getMaxDegree() const;
+
+    /** Sets the normalized coefficients @param C and @param S of degree @param n and order @param m
+     *  @throw std::out_of_range if m > n or n is greater than the maximum degree
+     */
+    void setCoefficients(unsigned int n, unsigned int m, double C, double S);
+    /// @return normalized coefficient Cnm, with the same exceptions as setCoefficients
+    double getC(unsigned int n, unsigned int m) const;
+    /// @return normalized coefficient Snm, with the same exceptions as setCoefficients
+    double getS(unsigned int n, unsigned int m) const;
+
+    /// @return position of degree @param n and order @param m in triangular arrays
+    static std::size_t index(unsigned int n, unsigned int m)
+    {
+        return std::size_t(n)*(n + 1)/2 + m;
+    };
+
+    private:
+    std::size_t checkedIndex(unsigned int n, unsigned int m) const;
+
+    double mu, radius;
+    unsigned int maxDegree;
+    std::vector<double> C, S;
+};
+
+/** Acceleration of the terms of degree 2 to N and order up to M of a
+ *  GravityField, by the Cunningham recursion of normalized V and W
+ *  functions, which has no singularity at the poles.
+ *  Every factor of the recursion and the truncated coefficients are
+ *  computed on construction, so each evaluation costs O(N*M) operations
+ *  and does not allocate memory.
+ *  See: O. Montenbruck, E. Gill, "Satellite Orbits" (2000), section 3.2.5
+ *
+ *  Evaluations write to buffers of the object: use a different object in
+ *  each thread.
+ */
+class GravityFieldEvaluator
+{
+    public:
+    /// Evaluator without terms
+    GravityFieldEvaluator() {};
+
+    /** Evaluator of @param field up to degree @param degree and order @param order
+     *  @throw std::invalid_argument if degree is greater than the maximum
+     *  degree of the field or order is greater than degree
+     */
+    GravityFieldEvaluator(const GravityField& field, unsigned int degree, unsigned int order);
+
+    /// @return acceleration in km/s^2 at @param position in km, without the central term
+    Vec3 getAcceleration(const Vec3& position) const;
+
+    private:
+    unsigned int degree{0}, order{0};
+    double radius{1}, scale{0};
+
+    /** Every array below is stored by orders: offsets[m] is the position of
+     *  degree m and order m, followed by degrees m + 1, m + 2... of order m
+     */
+    std::vector<std::size_t> offsets;
+
+    /// Truncated coefficients and factors of their acceleration, up to degree
+    std::vector<double> C, S, upper, lower, vertical;
+
+    /// Factors of the recursions of V and W, up to degree + 1
+    std::vector<double> sectoral, zonalA, zonalB;
+
+    /// V and W up to degree + 1, overwritten by every evaluation
+    mutable std::vector<double> V, W;
+};
+
+#endif
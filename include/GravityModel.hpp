@@ -0,0 +1,128 @@
+#ifndef GRAVITYMODEL_HPP
+#define GRAVITYMODEL_HPP
+
+#include <cmath>
+#include <vector>
+
+#include "CelestialBody.hpp"
+#include "FixedVector.hpp"
+#include "GravityField.hpp"
+#include "PropagationStats.hpp"
+#include "ThirdBody.hpp"
+
+/** Gravitational parameter and zonal constants of a central body, with the
+ *  zonal constants as stored in CelestialBody: Kn = mu*Jn*R^n in km^(n+3)*s^-2
+ */
+struct ZonalParameters
+{
+    double mu{0}, K2{0}, K3{0};
+};
+
+/** Two-body plus J2/J3 acceleration in km/s^2 at @param r in km, specialized
+ *  at compile time on the zonal terms that are set. Every power of r comes
+ *  from one square root and one division.
+ */
+template <bool J2, bool J3>
+Vec3 zonalAcceleration(const Vec3& r, const ZonalParameters& p)
+{
+    const double x = r[0], y = r[1], z = r[2];
+    const double r2 = x*x + y*y + z*z;
+    const double invR2 = 1/r2;
+    const double invR3 = invR2*std::sqrt(invR2);
+
+    Vec3 a = (-p.mu*invR3)*r;
+
+    if (J2 || J3)
+    {
+        const double invR5 = invR3*invR2;
+        const double z2r2 = z*z*invR2;
+
+        if (J2)
+        {
+            const double k = -1.5*p.K2*invR5;
+            const double xy = k*(1 - 5*z2r2);
+            a[0] += xy*x;
+            a[1] += xy*y;
+            a[2] += k*z*(3 - 5*z2r2);
+        }
+
+        if (J3)
+        {
+            const double k = -2.5*p.K3*invR5*invR2;
+            const double xy = k*z*(3 - 7*z2r2);
+            a[0] += xy*x;
+            a[1] += xy*y;
+            a[2] += k*(z*z*(6 - 7*z2r2) - 0.6*r2);
+        }
+    }
+
+    return a;
+}
+
+/** Earth rotation angle (IAU 2000) in radians, in [0, 2*pi), at @param seconds
+ *  since J2000. The time is taken as UT1, which is within about a minute of
+ *  the TT of the epochs, so the angle is off by up to about 0.004 rad.
+ */
+inline double earthRotationAngle(double seconds)
+{
+    const double days = seconds/86400;
+    const double turns = 0.7790572732640 + 0.00273781191135448*days + std::fmod(days, 1.0);
+    const double angle = 2*M_PI*std::fmod(turns, 1.0);
+    return angle < 0 ? angle + 2*M_PI : angle;
+}
+
+/** Gravity of a central body and of the third bodies that perturb orbits
+ *  around it. The kernel for its zonal terms is chosen once on construction,
+ *  so propagators build one per propagation and call getAcceleration at
+ *  every step without checking which terms are set.
+ *  Jeffery constants beyond J3 are ignored. If the body has a spherical
+ *  harmonics field, it is used instead of the Jeffery constants. The field is
+ *  evaluated in body-fixed axes, rotated from the inertial ones about z by
+ *  earthRotationAngle at the epoch of the perturbers plus t: precession,
+ *  nutation and polar motion are ignored.
+ *
+ *  Evaluations write to buffers of the object: use a different object in
+ *  each thread.
+ */
+class GravityModel
+{
+    public:
+    /// Field of a body without mass
+    GravityModel();
+    explicit GravityModel(const CelestialBody& body, const Perturbers& perturbers = {});
+
+    /// @return acceleration in km/s^2 at Ephemeris time @param t and @param position in km
+    Vec3 getAcceleration(double t, const Vec3& position) const
+    {
+        StatsCounters::countForceEvaluation();
+        Vec3 a = kernel(position, parameters);
+        if (hasField) a += fieldAcceleration(t, position);
+        for (const ThirdBodyEvaluator& body : thirdBodies)
+            a += body.getAcceleration(t, position);
+        return a;
+    };
+
+    private:
+    /// @return acceleration of the field at @param position, rotated to body-fixed axes at time @param t and back
+    Vec3 fieldAcceleration(double t, const Vec3& position) const
+    {
+        const double angle = earthRotationAngle(epoch + t);
+        const double c = std::cos(angle), s = std::sin(angle);
+        const Vec3 a = field.getAcceleration({c*position[0] + s*position[1], c*position[1] - s*position[0], position[2]});
+        return {c*a[0] - s*a[1], s*a[0] + c*a[1], a[2]};
+    };
+
+    typedef Vec3 (*Kernel)(const Vec3&, const ZonalParameters&);
+
+    Kernel kernel;
+    ZonalParameters parameters;
+
+    bool hasField{false};
+    GravityFieldEvaluator field;
+    /// Seconds since J2000 of time 0
+    double epoch{0};
+
+    std::vector<ThirdBodyEvaluator> thirdBodies;
+};
+
+#endif
@@ -0,0 +1,56 @@
+#ifndef KEPLERPROPAGATOR_HPP
+#define KEPLERPROPAGATOR_HPP
+
+#include "Propagator.hpp"
+
+/** Two-body orbit solved in closed form with universal variables, valid for
+ *  elliptic, parabolic and hyperbolic orbits alike.
+ *  See: Vallado, "Fundamentals of Astrodynamics and Applications", algorithm 8
+ */
+class KeplerOrbit : public AnalyticTrajectory
+{
+    public:
+    /// Orbit through state @param initial around a body of gravitational parameter @param mu
+    KeplerOrbit(const EphemerisEntry& initial, double mu);
+
+    /// @return state of the orbit at time @param t, before or after the initial one
+    EphemerisEntry at(double t) const override;
+
+    private:
+    Vec3 r0, v0;
+    double t0, mu;
+    /// Norm of r0, r0·v0/sqrt(mu) and inverse of the semi-major axis
+    double r0Norm, sigma0, alpha;
+    /// Orbital period, 0 if the orbit is not elliptic
+    double period{0};
+};
+
+/** Propagates the orbit analytically, considering only the point mass of the
+ *  central body. Nothing is integrated nor stored: the ephemeris becomes
+ *  analytic and each entry is computed exactly when it is asked for, so
+ *  lookups and output cost O(1) per sample whatever the final time.
+ */
+class KeplerPropagator : public Propagator
+{
+    public:
+    /** Resets the ephemeris and makes it analytic, with an entry every time step
+     *  @return 0 if no error happened during computation
+     *  @return 1 if there is no initial EphemerisEntry
+     *  @return 2 if centralBody still has default parameter == 0
+     *  @return 3 if final time and time set are set so that t0 >= (tf - dt)
+     *  @return 4 if centralBody has zonal terms or a gravity field, or there are third bodies,
+     *  which this method would ignore
+     */ 
+    int propagate(Enviroment& enviroment) override;
+
+    /** Propagates from the initial entry in the given enviroment to @param sink,
+     *  computing every entry from the orbit. Exit codes as above.
+     */
+    int propagate(Enviroment& enviroment, EphemerisSink& sink) override;
+
+    std::string getExitMessage(int) override;
+
+    std::unique_ptr<Propagator> clone() const override;
+};
+
+#endif
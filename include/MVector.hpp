@@ -5,11 +5,13 @@
 #include <stdexcept>
 #include <ostream>
 
+#include "MVectorExpression.hpp"
+
 /**
  *  Represents a vector in  the mathematical sense of the word
  *  which implements useful operators for linear algebra operations
  */
-class MVector
+class MVector : public MVectorExpression<MVector>
 {
     public:
     /// Constructs vector of size @param size with 0 in all elements
@@ -21,31 +23,30 @@ class MVector
     MVector(MVector&& source);
     MVector& operator=(MVector&& source);
 
-    /// @return same vector
-    MVector operator+() const;
-
-    /// @return sum of two vectors
-    MVector operator+(const MVector& other) const;
+    /** Evaluates @param expression in a single loop into a new vector
+     *  @throw std::invalid_argument if sizes inside the expression do not coincide
+     */
+    template <typename E>
+    MVector(const MVectorExpression<E>& expression);
 
-    /// @return vector with same magnitudes but opposite sign
-    MVector operator-() const;
+    /** Evaluates @param expression in a single loop into this vector. Memory
+     *  is only reallocated if the size of the expression differs from this one.
+     */
+    template <typename E>
+    MVector& operator=(const MVectorExpression<E>& expression);
 
-    /// @return vector which is this - other elements
-    MVector operator-(const MVector& other) const;
+    /// Adds @param expression element-wise to this vector
+    template <typename E>
+    MVector& operator+=(const MVectorExpression<E>& expression);
 
-    /// @return Dot product of two vectors
-    double operator*(const MVector& other) const;
+    /// Subtracts @param expression element-wise from this vector
+    template <typename E>
+    MVector& operator-=(const MVectorExpression<E>& expression);
 
     /** @return Cross product of two vectors
      *  @throw std::invalid_argument if either this or other is not size 3
      */
     MVector operator%(const MVector& other) const;
-    
-    /// @return vector multiplied by @param multiplier
-    MVector operator*(double multiplier) const;
-
-    /// @return vector divided by @param divider
-    MVector operator/(double divider) const;
 
     /// @return true iff all elements are equal
     bool operator==(const MVector& other) const;
@@ -72,11 +73,50 @@ class MVector
     MVector(unsigned int size, bool initializeZeros);
 };
 
-/// @return vector @param v multiplied by @param multiplier
-MVector operator*(double multiplier, const MVector& v);
-/// @return @param divided divided by vector @param v
-MVector operator/(double divider, const MVector& v);
-
 std::ostream &operator<<(std::ostream &os, const MVector &v);
 
+template <typename E>
+MVector::MVector(const MVectorExpression<E>& expression) : MVector(expression.size(), false)
+{
+    for (unsigned int i = 0; i < _size; i++)
+        data[i] = expression[i];
+}
+
+template <typename E>
+MVector& MVector::operator=(const MVectorExpression<E>& expression)
+{
+    // Expressions are element-wise, so evaluating in place is safe even
+    // if this vector appears in the expression
+    if (data != nullptr && _size == expression.size())
+    {
+        for (unsigned int i = 0; i < _size; i++)
+            data[i] = expression[i];
+        return *this;
+    }
+
+    return *this = MVector(expression);
+}
+
+template <typename E>
+MVector& MVector::operator+=(const MVectorExpression<E>& expression)
+{
+    if (_size != expression.size())
+        throw std::invalid_argument("Vector size must coincide");
+
+    for (unsigned int i = 0; i < _size; i++)
+        data[i] += expression[i];
+    return *this;
+}
+
+template <typename E>
+MVector& MVector::operator-=(const MVectorExpression<E>& expression)
+{
+    if (_size != expression.size())
+        throw std::invalid_argument("Vector size must coincide");
+
+    for (unsigned int i = 0; i < _size; i++)
+        data[i] -= expression[i];
+    return *this;
+}
+
 #endif
\ No newline at end of file
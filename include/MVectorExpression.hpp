@@ -0,0 +1,163 @@
+#ifndef MVECTOREXPRESSION_HPP
+#define MVECTOREXPRESSION_HPP
+
+#include <functional>
+#include <stdexcept>
+
+class MVector;
+
+/**
+ *  Base of every lazily evaluated MVector expression (CRTP). Arithmetic between
+ *  MVectors builds a tree of these objects instead of computing temporaries; the
+ *  tree is evaluated element by element in a single loop when it is assigned to
+ *  an MVector. Sizes are checked once when the tree is built.
+ *
+ *  Expressions hold references to the MVectors they were built from, so they
+ *  must not outlive them: assign to an MVector instead of storing them with auto.
+ */
+template <typename E>
+class MVectorExpression
+{
+    public:
+    /// @return element @param n of the evaluated expression
+    double operator[](unsigned int n) const { return self()[n]; };
+
+    /// @return size of the evaluated expression
+    unsigned int size() const { return self().size(); };
+
+    const E& self() const { return static_cast<const E&>(*this); };
+};
+
+/// MVectors are held by reference inside expressions, subexpressions by value
+template <typename E>
+struct MVectorOperand { using type = const E; };
+
+template <>
+struct MVectorOperand<MVector> { using type = const MVector&; };
+
+/// Element-wise operation between two expressions of the same size
+template <typename L, typename R, typename Op>
+class MVectorBinaryExpression : public MVectorExpression<MVectorBinaryExpression<L, R, Op>>
+{
+    public:
+    /// @throw std::invalid_argument if sizes of @param l and @param r differ
+    MVectorBinaryExpression(const L& l, const R& r) : l(l), r(r)
+    {
+        if (l.size() != r.size())
+            throw std::invalid_argument("Vector size must coincide");
+    };
+
+    double operator[](unsigned int n) const { return Op{}(l[n], r[n]); };
+    unsigned int size() const { return l.size(); };
+
+    private:
+    typename MVectorOperand<L>::type l;
+    typename MVectorOperand<R>::type r;
+};
+
+/// Element-wise operation between an expression and a scalar
+template <typename E, typename Op>
+class MVectorScalarExpression : public MVectorExpression<MVectorScalarExpression<E, Op>>
+{
+    public:
+    MVectorScalarExpression(const E& e, double scalar) : e(e), scalar(scalar) {};
+
+    double operator[](unsigned int n) const { return Op{}(e[n], scalar); };
+    unsigned int size() const { return e.size(); };
+
+    private:
+    typename MVectorOperand<E>::type e;
+    double scalar;
+};
+
+/// Divides the scalar by the element, used for scalar / vector
+struct MVectorReverseDivides
+{
+    double operator()(double element, double scalar) const { return scalar / element; };
+};
+
+/// Changes the sign of the element, the scalar is ignored
+struct MVectorNegate
+{
+    double operator()(double element, double) const { return -element; };
+};
+
+/// @return same expression
+template <typename E>
+const E& operator+(const MVectorExpression<E>& e)
+{
+    return e.self();
+}
+
+/// @return sum of two vectors
+template <typename L, typename R>
+MVectorBinaryExpression<L, R, std::plus<double>>
+operator+(const MVectorExpression<L>& l, const MVectorExpression<R>& r)
+{
+    return {l.self(), r.self()};
+}
+
+/// @return vector with same magnitudes but opposite sign
+template <typename E>
+MVectorScalarExpression<E, MVectorNegate> operator-(const MVectorExpression<E>& e)
+{
+    return {e.self(), 0};
+}
+
+/// @return vector which is l - r elements
+template <typename L, typename R>
+MVectorBinaryExpression<L, R, std::minus<double>>
+operator-(const MVectorExpression<L>& l, const MVectorExpression<R>& r)
+{
+    return {l.self(), r.self()};
+}
+
+/// @return vector multiplied by @param multiplier
+template <typename E>
+MVectorScalarExpression<E, std::multiplies<double>>
+operator*(const MVectorExpression<E>& e, double multiplier)
+{
+    return {e.self(), multiplier};
+}
+
+/// @return vector @param e multiplied by @param multiplier
+template <typename E>
+MVectorScalarExpression<E, std::multiplies<double>>
+operator*(double multiplier, const MVectorExpression<E>& e)
+{
+    return {e.self(), multiplier};
+}
+
+/// @return vector divided by @param divider
+template <typename E>
+MVectorScalarExpression<E, std::divides<double>>
+operator/(const MVectorExpression<E>& e, double divider)
+{
+    return {e.self(), divider};
+}
+
+/// @return @param divided divided by each element of vector @param e
+template <typename E>
+MVectorScalarExpression<E, MVectorReverseDivides>
+operator/(double divided, const MVectorExpression<E>& e)
+{
+    return {e.self(), divided};
+}
+
+/** @return Dot product of two vectors
+ *  @throw std::invalid_argument if sizes differ
+ */
+template <typename L, typename R>
+double operator*(const MVectorExpression<L>& l, const MVectorExpression<R>& r)
+{
+    if (l.size() != r.size())
+        throw std::invalid_argument("Vector size must coincide");
+
+    double result{0};
+    for (unsigned int i = 0; i < l.size(); i++)
+        result += l[i] * r[i];
+
+    return result;
+}
+
+#endif
@@ -0,0 +1,103 @@
+#ifndef MULTISTEPPROPAGATOR_HPP
+#define MULTISTEPPROPAGATOR_HPP
+
+#include <array>
+#include <vector>
+
+#include "GravityModel.hpp"
+#include "Propagator.hpp"
+
+/** Base of fixed step multistep methods, which reuse the accelerations of
+ *  the previous steps and need only two evaluations per step (predict,
+ *  evaluate, correct, evaluate). The first POINTS - 1 steps are taken with
+ *  Runge-Kutta 4 substeps. The history is restarted in the same way at the
+ *  first step at or after each restart time, so it never spans a
+ *  discontinuity of the force model such as a maneuver.
+ *  One entry is stored every time step.
+ */
+class MultistepPropagator : public Propagator
+{
+    public:
+    using Propagator::propagate;
+
+    /** Propagates from the initial entry in the given enviroment to @param sink
+     *  @return 0 if no error happened during computation
+     *  @return 1 if there is no initial EphemerisEntry
+     *  @return 2 if centralBody still has default parameter == 0
+     *  @return 3 if final time and time set are set so that t0 >= (tf - dt)
+     */ 
+    int propagate(Enviroment& enviroment, EphemerisSink& sink) override;
+
+    std::string getExitMessage(int) override;
+
+    /// Adds a time at which the force model is discontinuous
+    void addRestartTime(double t);
+
+    /// Removes all restart times
+    void clearRestartTimes();
+
+    /// @return restart times in increasing order
+    const std::vector<double>& getRestartTimes() const;
+
+    protected:
+    /// Number of back points: differences up to the eighth are kept
+    static constexpr unsigned int POINTS = 9;
+
+    /** Starts the method from the last POINTS @param states, evenly spaced by
+     *  @param h, and their @param accelerations, oldest first
+     */
+    virtual void start(const std::array<EphemerisEntry, POINTS>& states,
+                       const std::array<Vec3, POINTS>& accelerations, double h) = 0;
+
+    /// @return state after one more step of the method started last, at time @param t, in field @param gravity
+    virtual EphemerisEntry step(const GravityModel& gravity, double t) = 0;
+
+    private:
+    std::vector<double> restartTimes;
+};
+
+/// Adams-Bashforth predictor and Adams-Moulton corrector on positions and velocities
+class AdamsBashforthMoultonPropagator : public MultistepPropagator
+{
+    public:
+    std::unique_ptr<Propagator> clone() const override;
+
+    protected:
+    void start(const std::array<EphemerisEntry, POINTS>& states,
+               const std::array<Vec3, POINTS>& accelerations, double h) override;
+
+    EphemerisEntry step(const GravityModel& gravity, double t) override;
+
+    private:
+    /// Backward differences of the derivative (velocity, acceleration) at the last step, updated in place
+    std::array<State6, POINTS> differences;
+    State6 y;
+    double h{0};
+};
+
+/** Gauss-Jackson (summed Stormer-Cowell) method of eighth order: positions
+ *  are obtained directly from accelerations through their second sum and
+ *  velocities through their first sum, which keeps round-off from growing
+ *  over long arcs.
+ *  See: M. Berry, L. Healy, "Implementation of Gauss-Jackson integration for orbit propagation" (2004)
+ */
+class GaussJacksonPropagator : public MultistepPropagator
+{
+    public:
+    std::unique_ptr<Propagator> clone() const override;
+
+    protected:
+    void start(const std::array<EphemerisEntry, POINTS>& states,
+               const std::array<Vec3, POINTS>& accelerations, double h) override;
+
+    EphemerisEntry step(const GravityModel& gravity, double t) override;
+
+    private:
+    /// Backward differences of the acceleration at the last step, updated in place
+    std::array<Vec3, POINTS> differences;
+    /// First and second sums of the accelerations
+    Vec3 firstSum, secondSum;
+    double h{0};
+};
+
+#endif
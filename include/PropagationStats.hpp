@@ -0,0 +1,109 @@
+#ifndef PROPAGATIONSTATS_HPP
+#define PROPAGATIONSTATS_HPP
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+
+/// Work done by propagations, as counted by StatsCounters
+struct StatsCount
+{
+    /// Steps accepted by the propagator
+    std::uint64_t steps{0};
+    /// Steps rejected by adaptive propagators and taken again with a smaller step
+    std::uint64_t rejectedSteps{0};
+    /// Calls to GravityModel::getAcceleration
+    std::uint64_t forceEvaluations{0};
+    /// Seconds spent building GravityModels
+    double modelSeconds{0};
+};
+
+/** Counters that the propagators and GravityModel add to as they go. Each
+ *  thread has its own, so propagations in parallel never contend for them.
+ *  Unless ORBITAL_STATS is defined every member does nothing and compiles
+ *  to nothing.
+ */
+class StatsCounters
+{
+    public:
+#ifdef ORBITAL_STATS
+    static constexpr bool ENABLED = true;
+
+    /// @return counts of the calling thread since it started
+    static const StatsCount& get() { return count; };
+
+    static void countStep() { count.steps++; };
+    static void countRejectedStep() { count.rejectedSteps++; };
+    static void countForceEvaluation() { count.forceEvaluations++; };
+    /// @return seconds building GravityModels of the calling thread, for a StatsTimer
+    static double& modelSeconds() { return count.modelSeconds; };
+
+    private:
+    static inline thread_local StatsCount count{};
+#else
+    static constexpr bool ENABLED = false;
+
+    static StatsCount get() { return {}; };
+
+    static void countStep() {};
+    static void countRejectedStep() {};
+    static void countForceEvaluation() {};
+    static double& modelSeconds() { static double ignored; return ignored; };
+#endif
+};
+
+/** Adds to @param seconds the time on the monotonic clock between its
+ *  construction and its destruction. Does nothing unless ORBITAL_STATS is defined.
+ */
+class StatsTimer
+{
+    public:
+#ifdef ORBITAL_STATS
+    explicit StatsTimer(double& seconds) : seconds(seconds), begin(std::chrono::steady_clock::now()) {};
+    ~StatsTimer() { seconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count(); };
+
+    private:
+    double& seconds;
+    std::chrono::steady_clock::time_point begin;
+#else
+    explicit StatsTimer(double&) {};
+#endif
+
+    StatsTimer(const StatsTimer&) = delete;
+    StatsTimer& operator=(const StatsTimer&) = delete;
+};
+
+/** Counters and timers of the last propagation of an Enviroment, and the
+ *  memory its ephemeris took afterwards. Times are wall clock seconds.
+ */
+struct PropagationStats
+{
+    /// Propagations since the Enviroment was created
+    std::uint64_t runs{0};
+    /// Exit code of the propagator
+    int exitCode{0};
+
+    StatsCount count;
+
+    /// Checking that the third body tables cover the propagation
+    double checkSeconds{0};
+    /// Whole propagator run, including modelSeconds of count
+    double propagatorSeconds{0};
+    /// Whole propagation, from the checks to the last entry
+    double totalSeconds{0};
+
+    /// Entries and chunks of the ephemeris and the bytes they take
+    unsigned int entries{0}, chunks{0};
+    std::size_t ephemerisBytes{0};
+    /// Bytes of released chunks kept by EphemerisChunkPool
+    std::size_t poolBytes{0};
+
+    /// Outputs the statistics to @param os in a user friendly way
+    std::ostream& output(std::ostream& os) const;
+
+    /// Outputs the statistics to @param os as a JSON object in one line
+    std::ostream& writeJson(std::ostream& os) const;
+};
+
+#endif
@@ -1,8 +1,14 @@
 #ifndef PROPAGATOR_HPP
 #define PROPAGATOR_HPP
 
+#include <memory>
 #include <string>
 
+#include "Ephemeris.hpp"
+#include "EphemerisSink.hpp"
+#include "FixedVector.hpp"
+#include "PropagationStats.hpp"
+
 class Enviroment;
 
 class Propagator
@@ -11,11 +17,27 @@ class Propagator
     /** Resets the ephemeris and propagates it in the given enviroment
      *  @return 0 if no error happened during computation
      */  
-    virtual int propagate(Enviroment& enviroment) = 0;
+    virtual int propagate(Enviroment& enviroment);
+
+    /** Propagates from the first entry of the ephemeris of the given enviroment,
+     *  handing every entry to @param sink instead of storing it. The ephemeris
+     *  is not modified unless the sink does it.
+     *  @return 0 if no error happened during computation
+     */
+    virtual int propagate(Enviroment& enviroment, EphemerisSink& sink) = 0;
 
     /** @return an user friendly message corresponding to exit code in propagate
      */
     virtual std::string getExitMessage(int);
+
+    /// @return a new Propagator of the same type and settings
+    virtual std::unique_ptr<Propagator> clone() const = 0;
+
+    virtual ~Propagator() {};
+
+    protected:
+    /// @return number of steps of @param dt taken from @param t0 while t < tf - dt, as every propagator does
+    static unsigned int countSteps(double t0, double tf, double dt);
 };
 
 /** Uses the Leapfrog integration method to propagate the orbit.
@@ -25,15 +47,27 @@ class Propagator
  */
 class LeapfrogPropagator : public Propagator
 {
-    /** Resets the ephemeris and propagates it in the given enviroment
+    using Propagator::propagate;
+
+    /** Propagates from the initial entry in the given enviroment to @param sink
      *  @return 0 if no error happened during computation
      *  @return 1 if there is no initial EphemerisEntry
      *  @return 2 if centralBody still has default parameter == 0
      *  @return 3 if final time and time set are set so that t0 >= (tf - dt)
      */ 
-    int propagate(Enviroment& enviroment) override;
+    int propagate(Enviroment& enviroment, EphemerisSink& sink) override;
 
     std::string getExitMessage(int) override;
+
+    std::unique_ptr<Propagator> clone() const override;
 };
 
+/** Quintic Hermite interpolation between two states @param s0 and @param s1
+ *  with accelerations @param a0 and @param a1. Position is fifth order accurate,
+ *  so integrators can output samples at any time without limiting their step.
+ *  @return the interpolated state at time @param t
+ */
+EphemerisEntry interpolateQuintic(const EphemerisEntry& s0, const Vec3& a0, 
+                                  const EphemerisEntry& s1, const Vec3& a1, double t);
+
 #endif
\ No newline at end of file
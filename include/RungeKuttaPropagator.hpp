@@ -0,0 +1,92 @@
+#ifndef RUNGEKUTTAPROPAGATOR_HPP
+#define RUNGEKUTTAPROPAGATOR_HPP
+
+#include <vector>
+
+#include "GravityModel.hpp"
+#include "Propagator.hpp"
+
+/// Coefficients of an embedded Runge-Kutta pair
+struct ButcherTableau
+{
+    unsigned int stages;
+    std::vector<double> c;
+    std::vector<std::vector<double>> a;
+    /// Weights of the solution that is propagated
+    std::vector<double> b;
+    /// Weights of the propagated solution minus those of the embedded one
+    std::vector<double> e;
+    /// Order of the lower order solution of the pair, used to adapt the step
+    unsigned int errorOrder;
+    /// True if the last stage is the derivative at the end of the step
+    bool fsal;
+};
+
+/** Propagates the orbit with an embedded Runge-Kutta pair, adapting the step
+ *  so that the estimated local error stays within the absolute and relative
+ *  tolerances. Internal steps are independent of the time step of the
+ *  Enviroment: entries are stored every time step by interpolating inside the
+ *  internal steps (dense output).
+ */
+class AdaptiveRungeKuttaPropagator : public Propagator
+{
+    public:
+    using Propagator::propagate;
+
+    /** Propagates from the initial entry in the given enviroment to @param sink
+     *  @return 0 if no error happened during computation
+     *  @return 1 if there is no initial EphemerisEntry
+     *  @return 2 if centralBody still has default parameter == 0
+     *  @return 3 if final time and time set are set so that t0 >= (tf - dt)
+     *  @return 4 if the step became too small to meet the tolerances
+     */ 
+    int propagate(Enviroment& enviroment, EphemerisSink& sink) override;
+
+    std::string getExitMessage(int) override;
+
+    /** Sets the tolerances of the local error of each step: @param absolute in km
+     *  and km/s and @param relative to the magnitude of each coordinate
+     *  @throw std::invalid_argument if any of them is not greater than 0
+     */
+    void setTolerances(double absolute, double relative);
+
+    double getAbsoluteTolerance() const;
+    double getRelativeTolerance() const;
+
+    protected:
+    AdaptiveRungeKuttaPropagator(const ButcherTableau& tableau) : tableau(tableau) {};
+
+    private:
+    /// @return starting step size for state @param y at time @param t with derivative @param f
+    double initialStep(const GravityModel& gravity, double t, const State6& y, const State6& f) const;
+
+    /// @return weighted RMS norm of @param v using the tolerances and the magnitudes of @param y0 and @param y1
+    double errorNorm(const State6& v, const State6& y0, const State6& y1) const;
+
+    const ButcherTableau& tableau;
+    double absoluteTolerance{1e-10}, relativeTolerance{1e-10};
+};
+
+/** Dormand-Prince 5(4) pair: 7 stages, 6 derivative evaluations per step
+ *  since the last one is reused as the first one of the next step.
+ */
+class DormandPrincePropagator : public AdaptiveRungeKuttaPropagator
+{
+    public:
+    DormandPrincePropagator();
+
+    std::unique_ptr<Propagator> clone() const override;
+};
+
+/** Runge-Kutta-Fehlberg 7(8) pair: 13 stages. The eighth order solution is
+ *  propagated. Meant for tight tolerances over long arcs.
+ */
+class RungeKuttaFehlberg78Propagator : public AdaptiveRungeKuttaPropagator
+{
+    public:
+    RungeKuttaFehlberg78Propagator();
+
+    std::unique_ptr<Propagator> clone() const override;
+};
+
+#endif
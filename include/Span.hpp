@@ -0,0 +1,50 @@
+#ifndef SPAN_HPP
+#define SPAN_HPP
+
+#include <cstddef>
+#include <stdexcept>
+
+/**
+ *  Non-owning view of a contiguous sequence of elements. Stand-in for
+ *  std::span, which is not available in C++17. The viewed memory must
+ *  outlive the span and the span is invalidated if the owner reallocates.
+ */
+template <typename T>
+class Span
+{
+    public:
+    constexpr Span() : first(nullptr), count(0) {};
+    constexpr Span(T* first, std::size_t count) : first(first), count(count) {};
+
+    constexpr T* data() const { return first; };
+    constexpr std::size_t size() const { return count; };
+    constexpr bool empty() const { return count == 0; };
+
+    constexpr T* begin() const { return first; };
+    constexpr T* end() const { return first + count; };
+
+    /// @return element at index @param n. Not bounds checked
+    constexpr T& operator[](std::size_t n) const { return first[n]; };
+
+    /** @return element at index @param n
+     *  @throw std::out_of_range If @param n is an invalid index.
+     */
+    T& at(std::size_t n) const
+    {
+        if (n >= count)
+            throw std::out_of_range("Span index out of range");
+        return first[n];
+    };
+
+    /// @return view of @param length elements starting at @param offset
+    constexpr Span subspan(std::size_t offset, std::size_t length) const
+    {
+        return {first + offset, length};
+    };
+
+    private:
+    T* first;
+    std::size_t count;
+};
+
+#endif
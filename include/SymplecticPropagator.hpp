@@ -0,0 +1,66 @@
+#ifndef SYMPLECTICPROPAGATOR_HPP
+#define SYMPLECTICPROPAGATOR_HPP
+
+#include <vector>
+
+#include "Propagator.hpp"
+
+/** Propagates the orbit with a composition of Leapfrog substeps of lengths
+ *  w_i*dt. With suitable weights the composition is of higher order while
+ *  remaining symplectic, so energy stays bounded as with Leapfrog but much
+ *  larger time steps reach the same accuracy. The acceleration at the end of
+ *  a substep is reused at the start of the next one: each step costs one
+ *  evaluation per weight. One entry is stored every time step.
+ *  See: H. Yoshida, "Construction of higher order symplectic integrators" (1990)
+ */
+class SymplecticPropagator : public Propagator
+{
+    public:
+    using Propagator::propagate;
+
+    /** Propagates from the initial entry in the given enviroment to @param sink
+     *  @return 0 if no error happened during computation
+     *  @return 1 if there is no initial EphemerisEntry
+     *  @return 2 if centralBody still has default parameter == 0
+     *  @return 3 if final time and time set are set so that t0 >= (tf - dt)
+     */ 
+    int propagate(Enviroment& enviroment, EphemerisSink& sink) override;
+
+    std::string getExitMessage(int) override;
+
+    protected:
+    SymplecticPropagator(const std::vector<double>& weights) : weights(weights) {};
+
+    private:
+    /// Fraction of the time step covered by each Leapfrog substep, adding up to 1
+    const std::vector<double>& weights;
+};
+
+/// Fourth order, 3 substeps (Forest-Ruth, Yoshida's triple jump)
+class Yoshida4Propagator : public SymplecticPropagator
+{
+    public:
+    Yoshida4Propagator();
+
+    std::unique_ptr<Propagator> clone() const override;
+};
+
+/// Sixth order, 7 substeps (Yoshida's solution A)
+class Yoshida6Propagator : public SymplecticPropagator
+{
+    public:
+    Yoshida6Propagator();
+
+    std::unique_ptr<Propagator> clone() const override;
+};
+
+/// Eighth order, 15 substeps (Yoshida's solution D)
+class Yoshida8Propagator : public SymplecticPropagator
+{
+    public:
+    Yoshida8Propagator();
+
+    std::unique_ptr<Propagator> clone() const override;
+};
+
+#endif
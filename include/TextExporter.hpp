@@ -0,0 +1,107 @@
+#ifndef TEXTEXPORTER_HPP
+#define TEXTEXPORTER_HPP
+
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "Ephemeris.hpp"
+
+/// Layout of delimited text exports
+struct TextExportFormat
+{
+    /// ',' for CSV, '\t' for TSV
+    char separator{','};
+    /// Whether the first line names the columns
+    bool header{true};
+    /// Columns written, in order
+    std::vector<EphemerisColumn> columns{EphemerisColumn::T, EphemerisColumn::X, EphemerisColumn::Y,
+        EphemerisColumn::Z, EphemerisColumn::VX, EphemerisColumn::VY, EphemerisColumn::VZ};
+    /// Significant digits as printf's %g, up to 17, 0 for the shortest exact representation
+    int precision{0};
+    /// Threads formatting a whole Ephemeris, 0 for one per hardware thread
+    unsigned int threads{1};
+
+    /// @return the format of Ephemeris::output: tab separated, no header, 6 significant digits
+    static TextExportFormat ephemerisOutput()
+    {
+        TextExportFormat format;
+        format.separator = '\t';
+        format.header = false;
+        format.precision = 6;
+        return format;
+    };
+};
+
+/** Writes ephemeris entries as delimited text (CSV, TSV...). Values are
+ *  formatted with std::to_chars, with the shortest representation that
+ *  parses back to exactly the same double and regardless of the locale,
+ *  into a large buffer that is written to the stream in big blocks.
+ *  A whole Ephemeris can be formatted by several threads, each formatting
+ *  a chunk at a time, while the calling thread writes the chunks in order.
+ */
+class TextExporter
+{
+    public:
+    /// Size of the buffer, written to the stream whenever a row might not fit
+    static constexpr std::size_t BUFFER_SIZE = 1 << 22;
+
+    /// Writes to @param os with @param format, starting with the header if it has one
+    TextExporter(std::ostream& os, TextExportFormat format);
+    /// Writes what is left in the buffer
+    ~TextExporter();
+    TextExporter(const TextExporter&) = delete;
+    TextExporter& operator=(const TextExporter&) = delete;
+
+    /// Writes a row with @param entry
+    void write(const EphemerisEntry& entry);
+
+    /** Writes a row with each entry of @param ephemeris, formatted by as many
+     *  threads as the format says
+     */
+    void write(const Ephemeris& ephemeris);
+
+    /// Chunks formatted by the threads but not written yet, at most, per thread
+    static constexpr unsigned int CHUNKS_IN_FLIGHT = 2;
+
+    /// Writes the buffer to the stream
+    void flush();
+
+    /** Formats a row of @param values, ordered as the columns of the
+     *  ephemeris, into @param out, which must have room for maxRowSize(format) chars
+     *  @return pointer past the last character written
+     */
+    static char* formatRow(const TextExportFormat& format, const double* values, char* out);
+
+    /** @return longest row of @param format: every column, which may be repeated,
+     *  with the longest double and its separator or newline
+     */
+    static std::size_t maxRowSize(const TextExportFormat& format);
+
+    /// @return the line naming the columns of @param format, with its newline
+    static std::string header(const TextExportFormat& format);
+
+    /** @return columns named in @param names, separated by commas or spaces
+     *  @throw std::invalid_argument if a name is not t, x, y, z, vx, vy or vz
+     */
+    static std::vector<EphemerisColumn> parseColumns(const std::string& names);
+
+    private:
+    /** Formats the entries of chunk @param k of @param ephemeris, or the same
+     *  range of entries if it is analytic, into @param out
+     *  @return number of characters written
+     */
+    std::size_t formatChunk(const Ephemeris& ephemeris, unsigned int k, char* out) const;
+
+    /// Formats the chunks of @param ephemeris with @param threads threads
+    void writeParallel(const Ephemeris& ephemeris, unsigned int threads);
+
+    std::ostream& os;
+    TextExportFormat format;
+    /// maxRowSize of the format
+    std::size_t rowSize;
+    std::vector<char> buffer;
+    std::size_t used{0};
+};
+
+#endif
@@ -0,0 +1,162 @@
+#ifndef THIRDBODY_HPP
+#define THIRDBODY_HPP
+
+#include <functional>
+#include <istream>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "FixedVector.hpp"
+
+/** Position of a body as piecewise Chebyshev polynomials on consecutive
+ *  segments of equal length, the way planetary ephemerides are distributed.
+ *  Times are in seconds since J2000 and positions in km.
+ */
+class ChebyshevTable
+{
+    public:
+    /** Table of @param segments segments of @param span seconds from @param start,
+     *  each with @param coefficients coefficients per coordinate, all 0
+     *  @throw std::invalid_argument if span, segments or coefficients are not positive
+     */
+    ChebyshevTable(double start, double span, unsigned int segments, unsigned int coefficients);
+
+    /** Tabulates @param position from @param start to at least @param end, fitting
+     *  segments of @param span seconds with @param coefficients coefficients
+     *  @throw std::invalid_argument if end <= start, or as the constructor
+     */
+    static ChebyshevTable fit(const std::function<Vec3(double)>& position, double start, double end,
+                              double span, unsigned int coefficients);
+
+    double getStart() const;
+    double getEnd() const;
+    double getSpan() const;
+    unsigned int getSegments() const;
+    unsigned int getCoefficients() const;
+
+    /// @return true iff the table covers every time from @param t0 to @param t1
+    bool covers(double t0, double t1) const;
+
+    /// @return segment that contains time @param t, the first or last one if outside the table
+    unsigned int segment(double t) const;
+
+    /** @return the 3*getCoefficients() coefficients of @param segment, those of x, then y, then z
+     *  @throw std::out_of_range if there is no such segment
+     */
+    double* coefficients(unsigned int segment);
+    const double* coefficients(unsigned int segment) const;
+
+    /** @return position at @param t
+     *  @throw std::out_of_range if the table does not cover @param t
+     */
+    Vec3 at(double t) const;
+
+    private:
+    double start, span;
+    unsigned int segments, count;
+    std::vector<double> data;
+};
+
+/// Body whose gravity perturbs the orbit, with its position relative to the central body
+struct ThirdBody
+{
+    std::string name;
+    /// Standard gravitational parameter in km^3/s^2
+    double mu;
+    std::shared_ptr<const ChebyshevTable> table;
+
+    /** @return the Sun, tabulated from @param start to @param end in seconds since
+     *  J2000 from the low precision series of sunPosition
+     */
+    static ThirdBody sun(double start, double end);
+
+    /** @return the Moon, tabulated from @param start to @param end in seconds since
+     *  J2000 from the low precision series of moonPosition
+     */
+    static ThirdBody moon(double start, double end);
+};
+
+/** Geocentric position of the Sun in km at @param t seconds since J2000, in the
+ *  equatorial frame of J2000, from a series accurate to about 0.1%.
+ *  See: O. Montenbruck, E. Gill, "Satellite Orbits" (2000), section 3.3.2
+ */
+Vec3 sunPosition(double t);
+
+/** Geocentric position of the Moon in km at @param t seconds since J2000, in the
+ *  equatorial frame of J2000, from a series accurate to a few hundredths of a degree.
+ *  See: O. Montenbruck, E. Gill, "Satellite Orbits" (2000), section 3.3.2
+ */
+Vec3 moonPosition(double t);
+
+/** Third bodies that perturb orbits around the central body, and the epoch
+ *  that relates the times of the Ephemeris to those of their tables
+ */
+class Perturbers
+{
+    public:
+    void add(ThirdBody body);
+    /// Removes all bodies
+    void clear();
+    /// @return number of bodies
+    unsigned int size() const;
+    const std::vector<ThirdBody>& getBodies() const;
+
+    /// Sets seconds since J2000 of time 0 of the Ephemeris
+    void setEpoch(double seconds);
+    /// @return seconds since J2000 of time 0 of the Ephemeris
+    double getEpoch() const;
+
+    /// @return true iff every table covers Ephemeris times from @param t0 to @param t1
+    bool covers(double t0, double t1) const;
+
+    /** Adds the bodies of a table file written by save
+     *  @return number of bodies read
+     *  @throw std::invalid_argument if the file is not valid. Bodies read
+     *  until then are kept.
+     */
+    unsigned int load(std::istream& is);
+
+    /** Writes every body to @param os as text: a "body name mu" line, a
+     *  "table start span segments coefficients" line and a line per segment
+     *  with the coefficients of x, y and z
+     */
+    void save(std::ostream& os) const;
+
+    private:
+    std::vector<ThirdBody> bodies;
+    double epoch{0};
+};
+
+/** Acceleration that a ThirdBody causes on an orbit relative to the central
+ *  body. The coefficients of the segment in use and the last position
+ *  evaluated are cached, so each evaluation costs one Clenshaw recurrence
+ *  per coordinate at most.
+ *
+ *  Evaluations write to the cache of the object: use a different object in
+ *  each thread.
+ */
+class ThirdBodyEvaluator
+{
+    public:
+    /// Evaluator of @param body with Ephemeris time 0 at @param epoch seconds since J2000
+    ThirdBodyEvaluator(const ThirdBody& body, double epoch);
+
+    /// @return acceleration in km/s^2 at Ephemeris time @param t and @param position in km
+    Vec3 getAcceleration(double t, const Vec3& position) const;
+
+    /// @return position of the body at Ephemeris time @param t
+    Vec3 getPosition(double t) const;
+
+    private:
+    std::shared_ptr<const ChebyshevTable> table;
+    double mu, epoch;
+
+    mutable const double* coefficients{nullptr};
+    mutable double segmentStart{0}, segmentEnd{0};
+    mutable double lastTime;
+    mutable Vec3 lastPosition;
+};
+
+#endif
@@ -0,0 +1,66 @@
+#ifndef WORKSTEALINGPOOL_HPP
+#define WORKSTEALINGPOOL_HPP
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * Fixed set of worker threads that run indexed tasks. Each worker has its
+ * own queue: it takes tasks from the front of its queue and, once it is
+ * empty, steals from the back of the queues of the other workers. Tasks
+ * of very different duration are thus balanced without a shared queue.
+ */
+class WorkStealingPool
+{
+    public:
+    /// Starts @param threads workers, or one per hardware thread if 0
+    WorkStealingPool(unsigned int threads);
+    ~WorkStealingPool();
+    WorkStealingPool(const WorkStealingPool&) = delete;
+    WorkStealingPool& operator=(const WorkStealingPool&) = delete;
+
+    /// @return number of worker threads
+    unsigned int size() const;
+
+    /** Calls @param task with every index in order from @param order, in
+     *  parallel, and blocks until all of them finished. Tasks are dealt to
+     *  the workers in that order, so putting the longest first balances best.
+     *  @throw the first exception thrown by a task, once all have finished
+     */
+    void run(const std::vector<unsigned int>& order, const std::function<void(unsigned int)>& task);
+
+    private:
+    struct Queue
+    {
+        std::mutex mutex;
+        std::deque<unsigned int> tasks;
+    };
+
+    /// Loop of worker @param id
+    void work(unsigned int id);
+
+    /// @return true if a task was found for worker @param id, stored in @param task
+    bool next(unsigned int id, unsigned int& task);
+
+    std::vector<std::thread> threads;
+    std::vector<std::unique_ptr<Queue>> queues;
+
+    std::mutex mutex;
+    std::condition_variable started, finished;
+    const std::function<void(unsigned int)>* current{nullptr};
+    unsigned long generation{0};
+    unsigned int busy{0};
+    bool stopping{false};
+
+    std::atomic<bool> failed{false};
+    std::exception_ptr error;
+};
+
+#endif
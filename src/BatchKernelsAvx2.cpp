@@ -0,0 +1,44 @@
+#include "BatchKernels.hpp"
+
+// Compiled with AVX2 enabled (see CMakeLists.txt). Only called after
+// checking at runtime that the processor supports it.
+#ifdef ORBITAL_X86_SIMD
+
+#include <immintrin.h>
+
+namespace
+{
+    /// 4 doubles in an AVX register
+    struct Avx2Pack
+    {
+        static constexpr std::size_t WIDTH = 4;
+        __m256d v;
+
+        Avx2Pack() : v(_mm256_setzero_pd()) {};
+        Avx2Pack(__m256d v) : v(v) {};
+        Avx2Pack(double d) : v(_mm256_set1_pd(d)) {};
+
+        static Avx2Pack load(const double* p) { return _mm256_loadu_pd(p); };
+        void store(double* p) const { _mm256_storeu_pd(p, v); };
+    };
+
+    inline Avx2Pack operator+(Avx2Pack a, Avx2Pack b) { return _mm256_add_pd(a.v, b.v); }
+    inline Avx2Pack operator-(Avx2Pack a, Avx2Pack b) { return _mm256_sub_pd(a.v, b.v); }
+    inline Avx2Pack operator*(Avx2Pack a, Avx2Pack b) { return _mm256_mul_pd(a.v, b.v); }
+    inline Avx2Pack operator/(Avx2Pack a, Avx2Pack b) { return _mm256_div_pd(a.v, b.v); }
+    inline Avx2Pack sqrt(Avx2Pack a) { return _mm256_sqrt_pd(a.v); }
+}
+
+std::size_t leapfrogAvx2(BatchStateView state, const BatchKernelParams& params)
+{
+    return batchLeapfrogDispatch<Avx2Pack>(state, params);
+}
+
+#else
+
+std::size_t leapfrogAvx2(BatchStateView, const BatchKernelParams&)
+{
+    return 0;
+}
+
+#endif
@@ -0,0 +1,44 @@
+#include "BatchKernels.hpp"
+
+// Compiled with AVX-512F enabled (see CMakeLists.txt). Only called after
+// checking at runtime that the processor supports it.
+#ifdef ORBITAL_X86_SIMD
+
+#include <immintrin.h>
+
+namespace
+{
+    /// 8 doubles in an AVX-512 register
+    struct Avx512Pack
+    {
+        static constexpr std::size_t WIDTH = 8;
+        __m512d v;
+
+        Avx512Pack() : v(_mm512_setzero_pd()) {};
+        Avx512Pack(__m512d v) : v(v) {};
+        Avx512Pack(double d) : v(_mm512_set1_pd(d)) {};
+
+        static Avx512Pack load(const double* p) { return _mm512_loadu_pd(p); };
+        void store(double* p) const { _mm512_storeu_pd(p, v); };
+    };
+
+    inline Avx512Pack operator+(Avx512Pack a, Avx512Pack b) { return _mm512_add_pd(a.v, b.v); }
+    inline Avx512Pack operator-(Avx512Pack a, Avx512Pack b) { return _mm512_sub_pd(a.v, b.v); }
+    inline Avx512Pack operator*(Avx512Pack a, Avx512Pack b) { return _mm512_mul_pd(a.v, b.v); }
+    inline Avx512Pack operator/(Avx512Pack a, Avx512Pack b) { return _mm512_div_pd(a.v, b.v); }
+    inline Avx512Pack sqrt(Avx512Pack a) { return _mm512_sqrt_pd(a.v); }
+}
+
+std::size_t leapfrogAvx512(BatchStateView state, const BatchKernelParams& params)
+{
+    return batchLeapfrogDispatch<Avx512Pack>(state, params);
+}
+
+#else
+
+std::size_t leapfrogAvx512(BatchStateView, const BatchKernelParams&)
+{
+    return 0;
+}
+
+#endif
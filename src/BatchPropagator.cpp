@@ -0,0 +1,201 @@
+#include "BatchPropagator.hpp"
+#include "BatchKernels.hpp"
+#include <chrono>
+#include <cmath>
+#include <sstream>
+#include <stdexcept>
+
+namespace
+{
+    /// Single double, used for processors without SIMD and for leftover objects
+    struct ScalarPack
+    {
+        static constexpr std::size_t WIDTH = 1;
+        double v;
+
+        ScalarPack() : v(0) {};
+        ScalarPack(double v) : v(v) {};
+
+        static ScalarPack load(const double* p) { return *p; };
+        void store(double* p) const { *p = v; };
+    };
+
+    inline ScalarPack operator+(ScalarPack a, ScalarPack b) { return a.v + b.v; }
+    inline ScalarPack operator-(ScalarPack a, ScalarPack b) { return a.v - b.v; }
+    inline ScalarPack operator*(ScalarPack a, ScalarPack b) { return a.v * b.v; }
+    inline ScalarPack operator/(ScalarPack a, ScalarPack b) { return a.v / b.v; }
+    inline ScalarPack sqrt(ScalarPack a) { return std::sqrt(a.v); }
+
+    typedef std::size_t (*BatchKernel)(BatchStateView, const BatchKernelParams&);
+
+    /// @return widest kernel supported by this processor, checked only once
+    BatchKernel bestKernel(std::string* name)
+    {
+        static std::string kernelName;
+        static BatchKernel kernel = []()
+        {
+#ifdef ORBITAL_X86_SIMD
+            __builtin_cpu_init();
+            if (__builtin_cpu_supports("avx512f"))
+            {
+                kernelName = "avx512";
+                return &leapfrogAvx512;
+            }
+            if (__builtin_cpu_supports("avx2"))
+            {
+                kernelName = "avx2";
+                return &leapfrogAvx2;
+            }
+#endif
+            kernelName = "scalar";
+            return &leapfrogScalar;
+        }();
+
+        if (name != nullptr) *name = kernelName;
+        return kernel;
+    }
+}
+
+std::size_t leapfrogScalar(BatchStateView state, const BatchKernelParams& params)
+{
+    return batchLeapfrogDispatch<ScalarPack>(state, params);
+}
+
+void BatchPropagator::add(const EphemerisEntry& initial)
+{
+    if (x.empty())
+    {
+        t = initial.getTime();
+    }
+    else if (initial.getTime() != t)
+    {
+        throw std::invalid_argument("All objects of a batch must have the same reference time");
+    }
+
+    x.push_back(initial.getX());
+    y.push_back(initial.getY());
+    z.push_back(initial.getZ());
+    vx.push_back(initial.getVx());
+    vy.push_back(initial.getVy());
+    vz.push_back(initial.getVz());
+}
+
+unsigned int BatchPropagator::load(std::istream& is)
+{
+    unsigned int read{0}, lineNumber{0};
+    std::string line;
+
+    while (std::getline(is, line))
+    {
+        lineNumber++;
+        std::istringstream sline(line);
+        double values[6];
+        int n{0};
+        while (n < 6 && sline >> values[n]) n++;
+
+        if (n == 0 && sline.eof()) continue; // Empty line
+
+        std::string rest;
+        if (n != 6 || sline >> rest)
+            throw std::invalid_argument("Line " + std::to_string(lineNumber) + " must be: x y z vx vy vz");
+
+        add({values[0], values[1], values[2], values[3], values[4], values[5], t});
+        read++;
+    }
+
+    return read;
+}
+
+void BatchPropagator::clear()
+{
+    x.clear(); y.clear(); z.clear();
+    vx.clear(); vy.clear(); vz.clear();
+    t = 0;
+}
+
+unsigned int BatchPropagator::size() const
+{
+    return x.size();
+}
+
+int BatchPropagator::propagate(const CelestialBody& centralBody, const Perturbers& perturbers, double tf, double dt)
+{
+    if (x.empty()) return 1;
+    if (centralBody.getGravitationalParameter() == 0) return 2;
+    if (t >= tf - dt) return 3;
+    if (centralBody.getGravityField() != nullptr) return 4;
+    if (perturbers.size() > 0) return 5;
+
+    // Same stepping as LeapfrogPropagator, so both end at the same time
+    unsigned long steps{0};
+    double tEnd{t};
+    while (tEnd < tf - dt)
+    {
+        tEnd += dt;
+        steps++;
+    }
+
+    BatchKernelParams params;
+    params.mu = centralBody.getGravitationalParameter();
+    params.hasJ2 = centralBody.isJefferyConstantSet(2);
+    params.hasJ3 = centralBody.isJefferyConstantSet(3);
+    params.J2 = params.hasJ2 ? centralBody.getJefferyConstant(2) : 0;
+    params.J3 = params.hasJ3 ? centralBody.getJefferyConstant(3) : 0;
+    params.dt = dt;
+    params.steps = steps;
+
+    BatchStateView state{x.data(), y.data(), z.data(), vx.data(), vy.data(), vz.data(), x.size()};
+
+    auto start = std::chrono::steady_clock::now();
+
+    std::size_t done = bestKernel(nullptr)(state, params);
+    if (done < state.count)
+        leapfrogScalar(state.from(done), params);
+
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    throughput = elapsed.count() > 0 ? x.size()*static_cast<double>(steps)/elapsed.count() : 0;
+
+    t = tEnd;
+    return 0;
+}
+
+std::string BatchPropagator::getExitMessage(int i)
+{
+    switch(i)
+    {
+        case 0: return "Propagation succesful";
+        case 1: return "No objects have been loaded";
+        case 2: return "Central body has not been defined";
+        case 3: return "Final time or time step have not been set";
+        case 4: return "Central body has a gravity field, which batch propagation does not support: use propagate";
+        case 5: return "There are third bodies, which batch propagation does not support: use propagate";
+    }
+    return "Unknown exit code";
+}
+
+EphemerisEntry BatchPropagator::at(unsigned int n) const
+{
+    return {x.at(n), y.at(n), z.at(n), vx.at(n), vy.at(n), vz.at(n), t};
+}
+
+std::ostream& BatchPropagator::output(std::ostream& os) const
+{
+    for (unsigned int i = 0; i < size(); i++)
+    {
+        at(i).output(os, false) << '\n';
+    }
+
+    return os;
+}
+
+std::string BatchPropagator::getKernelName()
+{
+    std::string name;
+    bestKernel(&name);
+    return name;
+}
+
+double BatchPropagator::getThroughput() const
+{
+    return throughput;
+}
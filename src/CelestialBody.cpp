@@ -1,5 +1,7 @@
 #include "CelestialBody.hpp"
+#include "GravityField.hpp"
 #include <stdexcept>
+#include <string>
 
 double CelestialBody::getJefferyConstant(unsigned int n) const
 {
@@ -37,4 +39,57 @@ void CelestialBody::setJefferyConstant(unsigned int n, double constant)
     {
         J[n-2] = constant;
     }
-}
\ No newline at end of file
+}
+
+void CelestialBody::setGravityField(std::shared_ptr<const GravityField> field, unsigned int degree, unsigned int order)
+{
+    if (field == nullptr)
+        throw std::invalid_argument("The gravity field cannot be null");
+
+    std::shared_ptr<const GravityField> previous = std::move(this->field);
+    this->field = std::move(field);
+
+    try
+    {
+        setGravityFieldTruncation(degree, order);
+    }
+    catch(std::invalid_argument&)
+    {
+        this->field = std::move(previous);
+        throw;
+    }
+}
+
+void CelestialBody::setGravityFieldTruncation(unsigned int degree, unsigned int order)
+{
+    if (field == nullptr)
+        throw std::invalid_argument("The central body has no gravity field");
+    if (degree > field->getMaxDegree())
+        throw std::invalid_argument("The field only has coefficients up to degree " + std::to_string(field->getMaxDegree()));
+    if (order > degree)
+        throw std::invalid_argument("The order cannot be greater than the degree");
+
+    fieldDegree = degree;
+    fieldOrder = order;
+}
+
+void CelestialBody::clearGravityField()
+{
+    field.reset();
+    fieldDegree = fieldOrder = 0;
+}
+
+const std::shared_ptr<const GravityField>& CelestialBody::getGravityField() const
+{
+    return field;
+}
+
+unsigned int CelestialBody::getGravityFieldDegree() const
+{
+    return fieldDegree;
+}
+
+unsigned int CelestialBody::getGravityFieldOrder() const
+{
+    return fieldOrder;
+}
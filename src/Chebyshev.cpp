@@ -0,0 +1,30 @@
+#include "Chebyshev.hpp"
+#include <cmath>
+
+double chebyshevNode(unsigned int j, unsigned int n)
+{
+    return std::cos(M_PI*(j + 0.5)/n);
+}
+
+void chebyshevFit(const double* values, unsigned int n, double* c)
+{
+    // Discrete orthogonality of T_k at the nodes
+    for (unsigned int k = 0; k < n; k++)
+    {
+        double sum{0};
+        for (unsigned int j = 0; j < n; j++)
+            sum += values[j]*std::cos(M_PI*k*(j + 0.5)/n);
+        c[k] = (k == 0 ? 1.0 : 2.0)*sum/n;
+    }
+}
+
+void chebyshevDerivative(const double* c, unsigned int n, double* d)
+{
+    // d[k-1] = d[k+1] + 2k*c[k], with d[0] halved
+    d[n - 1] = 0;
+    if (n == 1) return;
+
+    for (unsigned int k = n - 1; k > 0; k--)
+        d[k - 1] = (k + 1 < n ? d[k + 1] : 0) + 2.0*k*c[k];
+    d[0] /= 2;
+}
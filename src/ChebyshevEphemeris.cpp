@@ -0,0 +1,358 @@
+#include "ChebyshevEphemeris.hpp"
+#include "Chebyshev.hpp"
+#include "EphemerisFile.hpp"
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <stdexcept>
+
+constexpr char ChebyshevEphemeris::MAGIC[8];
+
+namespace
+{
+    /** Fits and checks segments of a sampled trajectory. Segments go from one
+     *  entry to another, so that every entry is on a bound or inside a segment.
+     */
+    class SegmentFitter
+    {
+        public:
+        SegmentFitter(const Ephemeris& ephemeris, double tolerance, unsigned int coefficients) :
+            ephemeris(ephemeris), tolerance(tolerance), n(coefficients),
+            times(ephemeris.size()), positions(ephemeris.size()), values(3*coefficients)
+        {
+            for (unsigned int i = 0; i < ephemeris.size(); i++)
+            {
+                const EphemerisEntry entry = ephemeris.at(i);
+                times[i] = entry.getTime();
+                positions[i] = entry.getPosition();
+            }
+        }
+
+        /** Fits the segment from entry @param first to entry @param last in
+         *  @param c, 3n coefficients
+         *  @return true iff the position error at every entry of the segment is within tolerance
+         */
+        bool fit(unsigned int first, unsigned int last, double* c)
+        {
+            const double mid = (times[first] + times[last])/2, half = (times[last] - times[first])/2;
+            for (unsigned int j = 0; j < n; j++)
+            {
+                const Vec3 r = ephemeris.interpolate(mid + half*chebyshevNode(j, n)).getPosition();
+                for (unsigned int axis = 0; axis < 3; axis++)
+                    values[axis*n + j] = r[axis];
+            }
+            for (unsigned int axis = 0; axis < 3; axis++)
+                chebyshevFit(values.data() + axis*n, n, c + axis*n);
+
+            const double tolerance2 = tolerance*tolerance;
+            for (unsigned int i = first; i <= last; i++)
+            {
+                const double x = std::min(std::max((times[i] - mid)/half, -1.0), 1.0);
+                double error2{0};
+                for (unsigned int axis = 0; axis < 3; axis++)
+                {
+                    const double d = chebyshev(c + axis*n, n, x) - positions[i][axis];
+                    error2 += d*d;
+                }
+                if (error2 > tolerance2) return false;
+            }
+            return true;
+        }
+
+        double time(unsigned int i) const { return times[i]; }
+
+        private:
+        const Ephemeris& ephemeris;
+        double tolerance;
+        unsigned int n;
+        std::vector<double> times;
+        std::vector<Vec3> positions;
+        std::vector<double> values;
+    };
+
+    const unsigned int SERIES = 6;
+
+    /** Evaluates at @param x the six series x, y, z, vx, vy, vz of a segment, with their
+     *  @param n coefficients of each degree together in @param c, into @param state.
+     *  The six Clenshaw recurrences are independent and run side by side.
+     */
+    void evaluate(const double* c, unsigned int n, double x, double state[SERIES])
+    {
+        const double x2 = 2*x;
+        double b1[SERIES] = {}, b2[SERIES] = {};
+        for (unsigned int k = n - 1; k > 0; k--)
+        {
+            for (unsigned int i = 0; i < SERIES; i++)
+            {
+                const double b0 = c[k*SERIES + i] + x2*b1[i] - b2[i];
+                b2[i] = b1[i];
+                b1[i] = b0;
+            }
+        }
+        for (unsigned int i = 0; i < SERIES; i++)
+            state[i] = c[i] + x*b1[i] - b2[i];
+    }
+}
+
+ChebyshevEphemeris ChebyshevEphemeris::compress(const Ephemeris& ephemeris, double tolerance, unsigned int coefficients)
+{
+    if (ephemeris.size() < 2)
+        throw std::invalid_argument("Ephemeris has not been computed yet");
+    if (!(tolerance > 0))
+        throw std::invalid_argument("Tolerance must be positive");
+    if (coefficients < 4)
+        throw std::invalid_argument("There must be at least 4 coefficients per coordinate");
+
+    SegmentFitter fitter{ephemeris, tolerance, coefficients};
+    const unsigned int last = ephemeris.size() - 1;
+    const unsigned int size = 3*coefficients;
+
+    std::vector<double> bounds{fitter.time(0)}, data, c(size), fitted(size);
+    unsigned int first = 0, length = 1;
+    while (first < last)
+    {
+        // Grow the length of the last segment while it fits, then bisect between
+        // the longest one that fits and the shortest one that does not.
+        // Two entries always fit: with at least 4 coefficients the polynomial
+        // reproduces the cubic that interpolates between them.
+        const unsigned int remaining = last - first;
+        unsigned int good = 1, bad = remaining + 1;
+        fitter.fit(first, first + 1, fitted.data());
+
+        bool growing{true};
+        unsigned int trial = std::min(std::max(length, 2u), remaining);
+        while (trial > good && trial < bad)
+        {
+            if (fitter.fit(first, first + trial, c.data()))
+            {
+                good = trial;
+                fitted.swap(c);
+                trial = growing ? std::min(2*trial, remaining) : (good + bad)/2;
+            }
+            else
+            {
+                bad = trial;
+                growing = false;
+                trial = (good + bad)/2;
+            }
+        }
+
+        first += good;
+        length = good;
+        bounds.push_back(fitter.time(first));
+        data.insert(data.end(), fitted.begin(), fitted.end());
+    }
+
+    // Entries of the analytic ephemeris are at t0 + n*step: the last one must be inside
+    const double step = (bounds.back() - bounds.front())/last;
+    bounds.back() = std::max(bounds.back(), bounds.front() + last*step);
+
+    ChebyshevEphemeris compressed(std::move(bounds), data, coefficients, tolerance, step, ephemeris.size());
+    for (unsigned int i = 0; i < ephemeris.size(); i++)
+    {
+        const EphemerisEntry entry = ephemeris.at(i);
+        const double error = (compressed.at(entry.getTime()).getVelocity() - entry.getVelocity()).norm();
+        compressed.velocityError = std::max(compressed.velocityError, error);
+    }
+    return compressed;
+}
+
+ChebyshevEphemeris::ChebyshevEphemeris(std::vector<double> bounds, const std::vector<double>& positions,
+                                       unsigned int coefficients, double tolerance, double step, unsigned int count) :
+    bounds(std::move(bounds)), coefficients(coefficients), tolerance(tolerance), step(step), count(count)
+{
+    const unsigned int segments = getSegments();
+    const unsigned int n = coefficients, size = 3*n;
+
+    // Derivatives with respect to time: d/dt = 2/span d/dx
+    data.resize(SERIES*n*segments);
+    std::vector<double> derivative(n);
+    for (unsigned int s = 0; s < segments; s++)
+    {
+        const double scale = 2/(this->bounds[s + 1] - this->bounds[s]);
+        double* out = data.data() + s*SERIES*n;
+        for (unsigned int axis = 0; axis < 3; axis++)
+        {
+            const double* c = positions.data() + s*size + axis*n;
+            chebyshevDerivative(c, n, derivative.data());
+            for (unsigned int k = 0; k < n; k++)
+            {
+                out[k*SERIES + axis] = c[k];
+                out[k*SERIES + 3 + axis] = derivative[k]*scale;
+            }
+        }
+    }
+
+    // Buckets no wider than the shortest segment hold at most two segments,
+    // but there are never more than 8 per segment
+    double shortest = getEnd() - getStart();
+    for (unsigned int s = 0; s < segments; s++)
+        shortest = std::min(shortest, this->bounds[s + 1] - this->bounds[s]);
+
+    const double total = getEnd() - getStart();
+    const double bucketCount = std::min(std::ceil(total/shortest), 8.0*segments);
+    bucketWidth = total/bucketCount;
+    buckets.resize(static_cast<unsigned int>(bucketCount));
+    for (unsigned int b = 0, s = 0; b < buckets.size(); b++)
+    {
+        const double t = getStart() + b*bucketWidth;
+        while (s + 1 < segments && this->bounds[s + 1] <= t) s++;
+        buckets[b] = s;
+    }
+}
+
+ChebyshevEphemeris ChebyshevEphemeris::read(const std::string& path)
+{
+    std::ifstream file{path, std::ios::binary};
+    if (!file.is_open())
+        throw std::invalid_argument("Could not open file " + path);
+
+    ChebyshevEphemerisHeader header;
+    if (!file.read(reinterpret_cast<char*>(&header), sizeof(header)) ||
+        !std::equal(MAGIC, MAGIC + 8, header.magic))
+        throw std::invalid_argument(path + " is not a Chebyshev ephemeris file");
+    if (header.version != VERSION)
+        throw std::invalid_argument(path + " has unsupported version " + std::to_string(header.version));
+    if (header.byteOrder != EphemerisFile::BYTE_ORDER_MARK)
+        throw std::invalid_argument(path + " was written with a different byte order");
+    if (header.segments == 0 || header.segments > 0xffffffffULL || header.count < 2 ||
+        header.count > 0xffffffffULL || header.coefficients < 4)
+        throw std::invalid_argument(path + " is truncated or corrupted");
+
+    std::vector<double> bounds(header.segments + 1), data(3*header.coefficients*header.segments);
+    if (!file.read(reinterpret_cast<char*>(bounds.data()), bounds.size()*sizeof(double)) ||
+        !file.read(reinterpret_cast<char*>(data.data()), data.size()*sizeof(double)) ||
+        file.peek() != std::ifstream::traits_type::eof())
+        throw std::invalid_argument(path + " is truncated or corrupted");
+
+    std::uint64_t hash = EphemerisFile::hash(EphemerisFile::HASH_OFFSET, bounds.data(), bounds.size());
+    if (EphemerisFile::hash(hash, data.data(), data.size()) != header.checksum)
+        throw std::invalid_argument(path + " fails the checksum");
+
+    ChebyshevEphemeris compressed(std::move(bounds), data, header.coefficients, header.tolerance,
+                                  header.step, static_cast<unsigned int>(header.count));
+    compressed.velocityError = header.velocityError;
+    return compressed;
+}
+
+void ChebyshevEphemeris::write(const std::string& path) const
+{
+    std::ofstream file{path, std::ios::binary | std::ios::trunc};
+    if (!file.is_open())
+        throw std::invalid_argument("Could not open file " + path);
+
+    // Only positions are stored, velocities are derived again when reading
+    const unsigned int n = coefficients;
+    std::vector<double> positions;
+    positions.reserve(3*n*getSegments());
+    for (unsigned int s = 0; s < getSegments(); s++)
+    {
+        for (unsigned int axis = 0; axis < 3; axis++)
+        {
+            for (unsigned int k = 0; k < n; k++)
+                positions.push_back(data[(s*n + k)*SERIES + axis]);
+        }
+    }
+
+    ChebyshevEphemerisHeader header{};
+    std::copy(MAGIC, MAGIC + 8, header.magic);
+    header.version = VERSION;
+    header.byteOrder = EphemerisFile::BYTE_ORDER_MARK;
+    header.coefficients = coefficients;
+    header.segments = getSegments();
+    header.count = count;
+    header.tolerance = tolerance;
+    header.velocityError = velocityError;
+    header.step = step;
+    header.checksum = EphemerisFile::hash(EphemerisFile::hash(EphemerisFile::HASH_OFFSET, bounds.data(), bounds.size()),
+                                          positions.data(), positions.size());
+
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    file.write(reinterpret_cast<const char*>(bounds.data()), bounds.size()*sizeof(double));
+    file.write(reinterpret_cast<const char*>(positions.data()), positions.size()*sizeof(double));
+
+    file.close();
+    if (!file)
+        throw std::invalid_argument("Could not write file " + path);
+}
+
+unsigned int ChebyshevEphemeris::segment(double t) const
+{
+    const double b = std::floor((t - getStart())/bucketWidth);
+    const unsigned int bucket = static_cast<unsigned int>(std::min(std::max(b, 0.0), buckets.size() - 1.0));
+    const unsigned int first = buckets[bucket];
+    const unsigned int last = bucket + 1 < buckets.size() ? buckets[bucket + 1] : getSegments() - 1;
+
+    // Last segment of the bucket that starts at or before t
+    return std::upper_bound(bounds.begin() + first + 1, bounds.begin() + last + 1, t) - bounds.begin() - 1;
+}
+
+double ChebyshevEphemeris::normalized(unsigned int segment, double t) const
+{
+    const double a = bounds[segment], b = bounds[segment + 1];
+    return std::min(std::max((2*t - a - b)/(b - a), -1.0), 1.0);
+}
+
+EphemerisEntry ChebyshevEphemeris::at(double t) const
+{
+    if (t < getStart() || t > getEnd())
+        throw std::out_of_range("Time is outside of the compressed ephemeris");
+
+    const unsigned int s = segment(t);
+    double state[SERIES];
+    evaluate(data.data() + s*SERIES*coefficients, coefficients, normalized(s, t), state);
+    return EphemerisEntry(state[0], state[1], state[2], state[3], state[4], state[5], t);
+}
+
+double ChebyshevEphemeris::getStart() const
+{
+    return bounds.front();
+}
+
+double ChebyshevEphemeris::getEnd() const
+{
+    return bounds.back();
+}
+
+unsigned int ChebyshevEphemeris::getSegments() const
+{
+    return static_cast<unsigned int>(bounds.size() - 1);
+}
+
+unsigned int ChebyshevEphemeris::getCoefficients() const
+{
+    return coefficients;
+}
+
+double ChebyshevEphemeris::getTolerance() const
+{
+    return tolerance;
+}
+
+double ChebyshevEphemeris::getVelocityError() const
+{
+    return velocityError;
+}
+
+double ChebyshevEphemeris::getStep() const
+{
+    return step;
+}
+
+unsigned int ChebyshevEphemeris::getCount() const
+{
+    return count;
+}
+
+std::uint64_t ChebyshevEphemeris::fileSize() const
+{
+    return sizeof(ChebyshevEphemerisHeader) + (bounds.size() + 3ULL*coefficients*getSegments())*sizeof(double);
+}
+
+Ephemeris ChebyshevEphemeris::toEphemeris(std::shared_ptr<const ChebyshevEphemeris> trajectory)
+{
+    Ephemeris ephemeris;
+    ephemeris.setInitialEntry(trajectory->at(trajectory->getStart()));
+    ephemeris.setAnalytic(trajectory, trajectory->getStep(), trajectory->getCount());
+    return ephemeris;
+}
@@ -1,10 +1,131 @@
 #include "ConsoleHandler.hpp"
+#include "RungeKuttaPropagator.hpp"
+#include "KeplerPropagator.hpp"
+#include "SymplecticPropagator.hpp"
+#include "MultistepPropagator.hpp"
+#include "EphemerisFile.hpp"
+#include "ChebyshevEphemeris.hpp"
+#include "GravityField.hpp"
 #include <sstream>
 #include <stdexcept>
 #include <limits>
 #include <ios>
 #include <fstream>
 #include <cmath>
+#include <cstdlib>
+
+/** @return a new Propagator of the method named @param name, or nullptr
+ *  if there is none with that name
+ */
+static std::unique_ptr<Propagator> makePropagator(const std::string& name)
+{
+    if (name == "leapfrog") return std::unique_ptr<Propagator>(new LeapfrogPropagator());
+    if (name == "dopri5") return std::unique_ptr<Propagator>(new DormandPrincePropagator());
+    if (name == "rkf78") return std::unique_ptr<Propagator>(new RungeKuttaFehlberg78Propagator());
+    if (name == "yoshida4") return std::unique_ptr<Propagator>(new Yoshida4Propagator());
+    if (name == "yoshida6") return std::unique_ptr<Propagator>(new Yoshida6Propagator());
+    if (name == "yoshida8") return std::unique_ptr<Propagator>(new Yoshida8Propagator());
+    if (name == "abm") return std::unique_ptr<Propagator>(new AdamsBashforthMoultonPropagator());
+    if (name == "gj8") return std::unique_ptr<Propagator>(new GaussJacksonPropagator());
+    if (name == "kepler") return std::unique_ptr<Propagator>(new KeplerPropagator());
+    return nullptr;
+}
+
+/** Reads whitespace separated times from file @param in, queries them all at once
+ *  in the ephemeris of @param env and writes the results to file @param out
+ *  @return message for the user
+ *  @throw CommandError if a file cannot be used or a time cannot be queried
+ */
+static std::string batchQuery(Enviroment& env, std::string in, std::string out, bool interpolate)
+{
+    std::ifstream inFile{in};
+    if (!inFile.is_open())
+        throw CommandError("Unable to open file " + in);
+
+    vector<double> times;
+    double t;
+    while (inFile >> t)
+        times.push_back(t);
+
+    if (!inFile.eof())
+        throw CommandError("File " + in + " must only contain times in seconds");
+
+    vector<EphemerisEntry> results(times.size());
+    try
+    {
+        env.getEphemeris().when({times.data(), times.size()}, {results.data(), results.size()}, interpolate);
+    }
+    catch(std::logic_error& ex)
+    {
+        throw CommandError(ex.what());
+    }
+
+    std::ofstream outFile{out, std::ios::trunc};
+    if (!outFile.is_open())
+        throw CommandError("Unable to open file " + out);
+
+    for (auto& entry : results)
+    {
+        entry.output(outFile, false) << '\n';
+    }
+
+    return "Succesfully output " + std::to_string(results.size()) + " results to file";
+}
+
+/** Writes the ephemeris of @param env to file @param path as delimited text
+ *  separated by @param separator, with the columns and header set in @param env
+ *  @return message for the user
+ *  @throw CommandError if the file cannot be written
+ */
+static std::string exportText(Enviroment& env, const std::string& path, char separator)
+{
+    std::ofstream file{path, std::ios::binary | std::ios::trunc};
+    if (!file.is_open())
+        throw CommandError("Unable to open file");
+
+    TextExportFormat format = env.getTextExportFormat();
+    format.separator = separator;
+    {
+        TextExporter exporter{file, format};
+        exporter.write(env.getEphemeris());
+    }
+
+    file.close();
+    if (!file)
+        throw CommandError("Unable to write file");
+    return "Succesfully output " + std::to_string(env.getEphemeris().size()) + " results to file";
+}
+
+/** @return stats of the last propagation of @param env
+ *  @throw CommandError if they were compiled out or there has been no propagation
+ */
+static const PropagationStats& lastStats(Enviroment& env)
+{
+    if (!StatsCounters::ENABLED)
+        throw CommandError("Stats were compiled out, configure with -DORBITAL_STATS=ON to enable them");
+    if (env.getStats().runs == 0)
+        throw CommandError("Nothing has been propagated yet");
+    return env.getStats();
+}
+
+/// Julian date of J2000 and seconds per day, to convert epochs
+static constexpr double J2000 = 2451545.0, SECONDS_PER_DAY = 86400;
+
+/** Adds to @param env the third body made by @param make, tabulated for
+ *  @param days days from the epoch, with one more day on both sides
+ *  @return message for the user
+ *  @throw CommandError if @param days is not positive
+ */
+static std::string addThirdBody(Enviroment& env, double days, ThirdBody (*make)(double, double))
+{
+    if (!(days > 0))
+        throw CommandError("The number of days must be positive");
+
+    const double epoch = env.getPerturbers().getEpoch();
+    ThirdBody body = make(epoch - SECONDS_PER_DAY, epoch + (days + 1)*SECONDS_PER_DAY);
+    env.getPerturbers().add(body);
+    return "Added " + body.name + " tabulated in " + std::to_string(body.table->getSegments()) + " segments";
+}
 
 /* ConsoleHandler */
 ConsoleHandler::ConsoleHandler(Enviroment& env, std::istream& input, std::ostream& output) 
@@ -110,7 +231,7 @@ ConsoleHandler::ConsoleHandler(Enviroment& env, std::istream& input, std::ostrea
             }
             catch(std::invalid_argument& ex)
             {
-                return ex.what();
+                throw CommandError(ex.what());
             }
 
             if (env.getEphemerisEntryBuilder().isValid())
@@ -130,7 +251,7 @@ ConsoleHandler::ConsoleHandler(Enviroment& env, std::istream& input, std::ostrea
             }
             catch(std::invalid_argument& ex)
             {
-                return ex.what();
+                throw CommandError(ex.what());
             }            
             
             if (env.getEphemerisEntryBuilder().isValid())
@@ -206,7 +327,7 @@ ConsoleHandler::ConsoleHandler(Enviroment& env, std::istream& input, std::ostrea
             }
             catch(std::invalid_argument& ex)
             {
-                return ex.what();
+                throw CommandError(ex.what());
             }
 
             return "Final time set";
@@ -221,12 +342,99 @@ ConsoleHandler::ConsoleHandler(Enviroment& env, std::istream& input, std::ostrea
             }
             catch(std::invalid_argument& ex)
             {
-                return ex.what();
+                throw CommandError(ex.what());
             }
 
             return "Time step set";
         });
 
+    emplace("env output", {NUMBER}, 
+        "Keeps results only every given number of seconds, rounded to whole time steps (0 keeps every time step)",
+        [](Enviroment& env, std::vector<CommArgument> args) 
+        {
+            try
+            {
+                env.setOutputStep(args[0].getNumber(), false);
+            }
+            catch(std::invalid_argument& ex)
+            {
+                throw CommandError(ex.what());
+            }
+
+            return "Output step set";
+        });
+
+    emplace("env output interpolate", {NUMBER}, 
+        "Keeps results at exact multiples of the given number of seconds, interpolated between time steps (0 keeps every time step)",
+        [](Enviroment& env, std::vector<CommArgument> args) 
+        {
+            try
+            {
+                env.setOutputStep(args[0].getNumber(), true);
+            }
+            catch(std::invalid_argument& ex)
+            {
+                throw CommandError(ex.what());
+            }
+
+            return "Output step set";
+        });
+
+    emplace("env propagator", {STRING}, 
+        "Sets integration method: \"leapfrog\" (default), \"dopri5\", \"rkf78\", \"yoshida4\", \"yoshida6\", \"yoshida8\", \"abm\", \"gj8\" or \"kepler\" (two-body only, exact). Adaptive methods store an entry every time step",
+        [](Enviroment& env, std::vector<CommArgument> args) 
+        {
+            std::unique_ptr<Propagator> propagator = makePropagator(args[0].getString());
+            if (!propagator)
+                throw CommandError("Unknown propagator");
+
+            env.setPropagator(std::move(propagator));
+            return "Propagator set";
+        });
+
+    emplace("env tolerance", {NUMBER, NUMBER}, 
+        "Sets absolute (km and km/s) and relative tolerance of the local error of adaptive propagators",
+        [](Enviroment& env, std::vector<CommArgument> args) 
+        {
+            auto propagator = dynamic_cast<AdaptiveRungeKuttaPropagator*>(env.getPropagator());
+            if (propagator == nullptr)
+                throw CommandError("Current propagator does not use tolerances");
+
+            try
+            {
+                propagator->setTolerances(args[0].getNumber(), args[1].getNumber());
+            }
+            catch(std::invalid_argument& ex)
+            {
+                throw CommandError(ex.what());
+            }
+
+            return "Tolerances set";
+        });
+
+    emplace("env restart", {NUMBER}, 
+        "Adds a time at which multistep propagators restart, such as a maneuver or any other discontinuity of the forces",
+        [](Enviroment& env, std::vector<CommArgument> args) 
+        {
+            auto propagator = dynamic_cast<MultistepPropagator*>(env.getPropagator());
+            if (propagator == nullptr)
+                throw CommandError("Current propagator is not a multistep method");
+
+            propagator->addRestartTime(args[0].getNumber());
+            return "Restart time added";
+        });
+
+    emplace("env restart clear", {}, "Removes all restart times of multistep propagators",
+        [](Enviroment& env, std::vector<CommArgument> args) 
+        {
+            auto propagator = dynamic_cast<MultistepPropagator*>(env.getPropagator());
+            if (propagator == nullptr)
+                throw CommandError("Current propagator is not a multistep method");
+
+            propagator->clearRestartTimes();
+            return "Restart times removed";
+        });
+
     emplace("central grav", {NUMBER}, "Sets standard gravitational paramater of the central body in km^3/s^2",
         [](Enviroment& env, std::vector<CommArgument> args) 
         {
@@ -236,7 +444,7 @@ ConsoleHandler::ConsoleHandler(Enviroment& env, std::istream& input, std::ostrea
             }
             catch(std::invalid_argument& ex)
             {
-                return ex.what();
+                throw CommandError(ex.what());
             }
 
             return "Gravitational paramater set";
@@ -252,32 +460,467 @@ ConsoleHandler::ConsoleHandler(Enviroment& env, std::istream& input, std::ostrea
             }
             catch(std::invalid_argument& ex)
             {
-                return ex.what();
+                throw CommandError(ex.what());
             }
 
             return "Jeffery constant set";
         });
 
+    emplace("central field", {STRING},
+        "Loads a spherical harmonics gravity field from an ICGEM (.gfc) file, used to its full degree and order "
+        "instead of the Jeffery constants and rotating with the Earth from the epoch. Also sets the gravitational parameter "
+        "of the central body",
+        [](Enviroment& env, std::vector<CommArgument> args)
+        {
+            std::ifstream file{args[0].getString()};
+            if (!file.is_open())
+                throw CommandError("Unable to open file");
+
+            try
+            {
+                auto field = std::make_shared<const GravityField>(GravityField::read(file));
+                unsigned int degree = field->getMaxDegree();
+                env.getCentralBody().setGravitationalParameter(field->getGravitationalParameter());
+                env.getCentralBody().setGravityField(field, degree, degree);
+                return "Loaded gravity field of degree and order " + std::to_string(degree);
+            }
+            catch(std::invalid_argument& ex)
+            {
+                throw CommandError(ex.what());
+            }
+        });
+
+    emplace("central field degree", {NUMBER, NUMBER},
+        "Sets the degree and order to which the gravity field is evaluated in the next propagations",
+        [](Enviroment& env, std::vector<CommArgument> args)
+        {
+            if (args[0].getNumber() < 0 || args[1].getNumber() < 0)
+                throw CommandError("The degree and order cannot be negative");
+
+            try
+            {
+                env.getCentralBody().setGravityFieldTruncation(args[0].getNumber(), args[1].getNumber());
+            }
+            catch(std::invalid_argument& ex)
+            {
+                throw CommandError(ex.what());
+            }
+
+            return "Gravity field degree and order set";
+        });
+
+    emplace("central field clear", {}, "Removes the gravity field, so the Jeffery constants are used again",
+        [](Enviroment& env, std::vector<CommArgument> args)
+        {
+            env.getCentralBody().clearGravityField();
+            return "Gravity field removed";
+        });
+
+    emplace("env epoch", {NUMBER}, "Sets the Julian date (TT) of time 0 of the ephemeris, which places the third bodies and "
+        "orients the gravity field",
+        [](Enviroment& env, std::vector<CommArgument> args)
+        {
+            env.getPerturbers().setEpoch((args[0].getNumber() - J2000)*SECONDS_PER_DAY);
+            return "Epoch set";
+        });
+
+    emplace("thirdbody sun", {NUMBER},
+        "Adds the Sun as a third body, tabulated from an analytic series for the given number of days from the epoch",
+        [](Enviroment& env, std::vector<CommArgument> args)
+        {
+            return addThirdBody(env, args[0].getNumber(), ThirdBody::sun);
+        });
+
+    emplace("thirdbody moon", {NUMBER},
+        "Adds the Moon as a third body, tabulated from an analytic series for the given number of days from the epoch",
+        [](Enviroment& env, std::vector<CommArgument> args)
+        {
+            return addThirdBody(env, args[0].getNumber(), ThirdBody::moon);
+        });
+
+    emplace("thirdbody load", {STRING}, "Adds the third bodies of a Chebyshev table file written with \"thirdbody save\"",
+        [](Enviroment& env, std::vector<CommArgument> args)
+        {
+            std::ifstream file{args[0].getString()};
+            if (!file.is_open())
+                throw CommandError("Unable to open file");
+
+            try
+            {
+                unsigned int read = env.getPerturbers().load(file);
+                return "Loaded " + std::to_string(read) + " third bodies, "
+                    + std::to_string(env.getPerturbers().size()) + " in total";
+            }
+            catch(std::invalid_argument& ex)
+            {
+                throw CommandError(ex.what());
+            }
+        });
+
+    emplace("thirdbody save", {STRING}, "Sets the Chebyshev tables of every third body in file with given name",
+        [](Enviroment& env, std::vector<CommArgument> args)
+        {
+            std::ofstream file{args[0].getString(), std::ios::trunc};
+            if (!file.is_open())
+                throw CommandError("Unable to open file");
+
+            env.getPerturbers().save(file);
+            return "Third bodies saved";
+        });
+
+    emplace("thirdbody clear", {}, "Removes all third bodies",
+        [](Enviroment& env, std::vector<CommArgument> args)
+        {
+            env.getPerturbers().clear();
+            return "Third bodies removed";
+        });
+
     emplace("propagate", {}, "Propagates the orbit",
         [](Enviroment& env, std::vector<CommArgument> args) 
         {
-            int code = env.propagate();
-            return env.getPropagator()->getExitMessage(code);
+            try
+            {
+                int code = env.propagate();
+                if (code != 0)
+                    throw CommandError(env.getPropagator()->getExitMessage(code));
+                return env.getPropagator()->getExitMessage(code);
+            }
+            catch(std::out_of_range& ex)
+            {
+                throw CommandError(ex.what());
+            }
         });
 
-    emplace("results to file", {STRING}, "Sets position and velocity data of ephemeris in file with given name",
+    emplace("propagate to file", {STRING}, 
+        "Propagates the orbit writing position and velocity data straight to file with given name, without keeping them in memory",
+        [](Enviroment& env, std::vector<CommArgument> args) 
+        {
+            try
+            {
+                TextFileSink sink{args[0].getString()};
+                int code = env.propagate(sink);
+                if (code != 0)
+                    throw CommandError(env.getPropagator()->getExitMessage(code));
+                return env.getPropagator()->getExitMessage(code);
+            }
+            catch(std::logic_error& ex)
+            {
+                throw CommandError(ex.what());
+            }
+        });
+
+    emplace("propagate to binary file", {STRING}, 
+        "Propagates the orbit writing it straight to a binary file with given name, without keeping it in memory",
+        [](Enviroment& env, std::vector<CommArgument> args) 
+        {
+            try
+            {
+                BinaryFileSink sink{args[0].getString(), env.getCentralBody(), env.getTimeStep()};
+                int code = env.propagate(sink);
+                if (code != 0)
+                    throw CommandError(env.getPropagator()->getExitMessage(code));
+                return env.getPropagator()->getExitMessage(code);
+            }
+            catch(std::logic_error& ex)
+            {
+                throw CommandError(ex.what());
+            }
+        });
+
+    emplace("stats", {}, 
+        "Displays steps, force evaluations and times of the last propagation, and the memory of its ephemeris",
+        [](Enviroment& env, std::vector<CommArgument> args) 
+        {
+            std::stringstream ss;
+            lastStats(env).output(ss);
+            return ss.str();
+        });
+
+    emplace("stats to file", {STRING}, "Sets stats of the last propagation as JSON in file with given name",
+        [](Enviroment& env, std::vector<CommArgument> args) 
+        {
+            const PropagationStats& stats = lastStats(env);
+            std::ofstream file{args[0].getString(), std::ios::trunc};
+            if (!file.is_open())
+                throw CommandError("Unable to open file");
+
+            stats.writeJson(file) << '\n';
+            return "Succesfully output stats to file";
+        });
+
+    emplace("stats dump", {STRING}, 
+        "Appends the stats of every following propagation as one line of JSON to file with given name",
+        [](Enviroment& env, std::vector<CommArgument> args) 
+        {
+            if (!StatsCounters::ENABLED)
+                throw CommandError("Stats were compiled out, configure with -DORBITAL_STATS=ON to enable them");
+
+            env.setStatsFile(args[0].getString());
+            return "Stats of every propagation will be appended to " + args[0].getString();
+        });
+
+    emplace("stats dump off", {}, "Stops appending stats of propagations to a file",
+        [](Enviroment& env, std::vector<CommArgument> args) 
+        {
+            env.setStatsFile("");
+            return "Stats are no longer written after propagations";
+        });
+
+    emplace("batch load", {STRING}, "Adds objects to the batch from a file with one \"x y z vx vy vz\" line per object, in km and km/s",
+        [](Enviroment& env, std::vector<CommArgument> args) 
+        {
+            std::ifstream file{args[0].getString()};
+            if (!file.is_open())
+                throw CommandError("Unable to open file");
+
+            try
+            {
+                unsigned int read = env.getBatchPropagator().load(file);
+                return "Loaded " + std::to_string(read) + " objects, " 
+                    + std::to_string(env.getBatchPropagator().size()) + " in batch";
+            }
+            catch(std::invalid_argument& ex)
+            {
+                throw CommandError(ex.what());
+            }
+        });
+
+    emplace("batch clear", {}, "Removes all objects from the batch",
+        [](Enviroment& env, std::vector<CommArgument> args) 
+        {
+            env.getBatchPropagator().clear();
+            return "Batch cleared";
+        });
+
+    emplace("batch propagate", {}, "Propagates all objects of the batch together until the final time",
+        [](Enviroment& env, std::vector<CommArgument> args) 
+        {
+            BatchPropagator& batch = env.getBatchPropagator();
+            int code = batch.propagate(env.getCentralBody(), env.getPerturbers(), env.getFinalTime(), env.getTimeStep());
+            if (code != 0)
+                throw CommandError(batch.getExitMessage(code));
+
+            std::stringstream ss;
+            ss << batch.getExitMessage(code) << " (" << BatchPropagator::getKernelName() << " kernel, "
+               << batch.getThroughput() << " object-steps/s)";
+            return ss.str();
+        });
+
+    emplace("batch results to file", {STRING}, "Sets current position and velocity of every object of the batch in file with given name",
+        [](Enviroment& env, std::vector<CommArgument> args) 
+        {
+            std::ofstream file{args[0].getString(), std::ios::trunc};
+
+            if (file.is_open())
+            {
+                env.getBatchPropagator().output(file);
+                file.close();
+                return "Succesfully output results to file";
+            }
+
+            throw CommandError("Unable to open file");
+        });
+
+    emplace("ensemble load", {STRING}, "Adds members to the ensemble from a file with one \"x y z vx vy vz tf dt\" line per member, in km, km/s and s",
+        [](Enviroment& env, std::vector<CommArgument> args) 
+        {
+            std::ifstream file{args[0].getString()};
+            if (!file.is_open())
+                throw CommandError("Unable to open file");
+
+            try
+            {
+                unsigned int read = env.getEnsemble().load(file);
+                return "Loaded " + std::to_string(read) + " members, " 
+                    + std::to_string(env.getEnsemble().size()) + " in ensemble";
+            }
+            catch(std::invalid_argument& ex)
+            {
+                throw CommandError(ex.what());
+            }
+        });
+
+    emplace("ensemble clear", {}, "Removes all members from the ensemble",
+        [](Enviroment& env, std::vector<CommArgument> args) 
+        {
+            env.getEnsemble().clear();
+            return "Ensemble cleared";
+        });
+
+    emplace("ensemble propagate", {NUMBER}, "Propagates all members of the ensemble with the given number of threads (0 for all cores)",
+        [](Enviroment& env, std::vector<CommArgument> args) 
+        {
+            if (args[0].getNumber() < 0)
+                throw CommandError("Number of threads cannot be negative");
+
+            unsigned int failed = env.getEnsemble().propagate(env.getCentralBody(), env.getPerturbers(),
+                                                              *env.getPropagator(), env.getOutputStep(),
+                                                              env.isOutputInterpolated(), (unsigned int) args[0].getNumber());
+            if (failed == 0)
+                return std::string{"Propagation succesful"};
+
+            throw CommandError(std::to_string(failed) + " of " + std::to_string(env.getEnsemble().size()) + " propagations failed");
+        });
+
+    emplace("ensemble results to file", {STRING}, "Sets last position and velocity of every member of the ensemble in file with given name",
         [](Enviroment& env, std::vector<CommArgument> args) 
         {
             std::ofstream file{args[0].getString(), std::ios::trunc};
 
             if (file.is_open())
             {
-                env.getEphemeris().output(file, false);
+                env.getEnsemble().output(file);
+                file.close();
+                return "Succesfully output results to file";
+            }
+
+            throw CommandError("Unable to open file");
+        });
+
+    emplace("results to file", {STRING}, "Sets position and velocity data of ephemeris in file with given name",
+        [](Enviroment& env, std::vector<CommArgument> args) 
+        {
+            std::ofstream file{args[0].getString(), std::ios::binary | std::ios::trunc};
+
+            if (file.is_open())
+            {
+                // Same text as Ephemeris::output, formatted by the export threads
+                TextExportFormat format = TextExportFormat::ephemerisOutput();
+                format.threads = env.getTextExportFormat().threads;
+                {
+                    TextExporter exporter{file, format};
+                    exporter.write(env.getEphemeris());
+                }
                 file.close();
                 return "Succesfully output results to file";
             }
 
-            return "Unable to open file";
+            throw CommandError("Unable to open file");
+        });
+
+    emplace("results to csv", {STRING}, 
+        "Sets ephemeris in a comma separated file with given name, with full precision",
+        [](Enviroment& env, std::vector<CommArgument> args) 
+        {
+            return exportText(env, args[0].getString(), ',');
+        });
+
+    emplace("results to tsv", {STRING}, 
+        "Sets ephemeris in a tab separated file with given name, with full precision",
+        [](Enviroment& env, std::vector<CommArgument> args) 
+        {
+            return exportText(env, args[0].getString(), '\t');
+        });
+
+    emplace("export columns", {STRING}, 
+        "Sets the columns of csv and tsv files, separated by commas, from t, x, y, z, vx, vy and vz",
+        [](Enviroment& env, std::vector<CommArgument> args) 
+        {
+            try
+            {
+                env.getTextExportFormat().columns = TextExporter::parseColumns(args[0].getString());
+            }
+            catch(std::invalid_argument& ex)
+            {
+                throw CommandError(ex.what());
+            }
+
+            return std::string{"Columns set"};
+        });
+
+    emplace("export threads", {NUMBER}, 
+        "Sets the number of threads formatting results written to text files (0 for all cores, default 1)",
+        [](Enviroment& env, std::vector<CommArgument> args) 
+        {
+            if (args[0].getNumber() < 0)
+                throw CommandError("Number of threads cannot be negative");
+
+            env.getTextExportFormat().threads = static_cast<unsigned int>(args[0].getNumber());
+            return "Export threads set";
+        });
+
+    emplace("export header", {NUMBER}, 
+        "Sets whether csv and tsv files start with a line naming the columns (1, default) or not (0)",
+        [](Enviroment& env, std::vector<CommArgument> args) 
+        {
+            env.getTextExportFormat().header = args[0].getNumber() != 0;
+            return "Header option set";
+        });
+
+    emplace("results to binary file", {STRING}, 
+        "Sets ephemeris, central body and time step in a compact binary file with given name",
+        [](Enviroment& env, std::vector<CommArgument> args) 
+        {
+            try
+            {
+                EphemerisFile::write(args[0].getString(), env.getEphemeris(), env.getCentralBody(), env.getTimeStep());
+            }
+            catch(std::invalid_argument& ex)
+            {
+                throw CommandError(ex.what());
+            }
+
+            return "Succesfully output " + std::to_string(env.getEphemeris().size()) + " entries to file";
+        });
+
+    emplace("results from binary file", {STRING}, 
+        "Loads ephemeris, central body and time step from a binary file written with \"results to binary file\"",
+        [](Enviroment& env, std::vector<CommArgument> args) 
+        {
+            try
+            {
+                EphemerisFile file{args[0].getString()};
+                env.setEphemeris(file.getEphemeris());
+                env.setCentralBody(file.getCentralBody());
+                if (file.getTimeStep() > 0)
+                    env.setTimeStep(file.getTimeStep());
+            }
+            catch(std::invalid_argument& ex)
+            {
+                throw CommandError(ex.what());
+            }
+
+            return "Loaded " + std::to_string(env.getEphemeris().size()) + " entries";
+        });
+
+    emplace("results to chebyshev file", {STRING, NUMBER},
+        "Fits Chebyshev polynomials to the ephemeris, with the given position tolerance in km, and sets them in a compact file with given name",
+        [](Enviroment& env, std::vector<CommArgument> args)
+        {
+            try
+            {
+                ChebyshevEphemeris compressed = ChebyshevEphemeris::compress(env.getEphemeris(), args[1].getNumber());
+                compressed.write(args[0].getString());
+                std::stringstream ss;
+                ss << "Succesfully output " << compressed.getSegments() << " segments (" << compressed.fileSize()
+                   << " bytes) to file, with velocity error up to " << compressed.getVelocityError() << " km/s";
+                return ss.str();
+            }
+            catch(std::invalid_argument& ex)
+            {
+                throw CommandError(ex.what());
+            }
+        });
+
+    emplace("results from chebyshev file", {STRING},
+        "Loads the ephemeris from a file written with \"results to chebyshev file\", computing entries from its polynomials",
+        [](Enviroment& env, std::vector<CommArgument> args)
+        {
+            std::shared_ptr<const ChebyshevEphemeris> compressed;
+            try
+            {
+                compressed = std::make_shared<const ChebyshevEphemeris>(ChebyshevEphemeris::read(args[0].getString()));
+                env.setEphemeris(ChebyshevEphemeris::toEphemeris(compressed));
+            }
+            catch(std::invalid_argument& ex)
+            {
+                throw CommandError(ex.what());
+            }
+
+            std::stringstream ss;
+            ss << "Loaded " << env.getEphemeris().size() << " entries, with velocity error up to "
+               << compressed->getVelocityError() << " km/s";
+            return ss.str();
         });
 
     emplace("results at", {NUMBER}, "Outputs position and velocity data at closest time calculated to the console",
@@ -290,8 +933,25 @@ ConsoleHandler::ConsoleHandler(Enviroment& env, std::istream& input, std::ostrea
             }
             catch(std::invalid_argument& ex)
             {
-                std::string message{ex.what()};
-                return message;
+                throw CommandError(ex.what());
+            }
+
+            std::stringstream ss;
+            entry.output(ss, true);
+            return ss.str();
+        });
+
+    emplace("results interpolate", {NUMBER}, "Outputs position and velocity data interpolated at the exact given time to the console",
+        [](Enviroment& env, std::vector<CommArgument> args) 
+        {
+            EphemerisEntry entry;
+            try
+            {
+                entry = env.getEphemeris().interpolate(args[0].getNumber());
+            }
+            catch(std::logic_error& ex)
+            {
+                throw CommandError(ex.what());
             }
 
             std::stringstream ss;
@@ -299,6 +959,20 @@ ConsoleHandler::ConsoleHandler(Enviroment& env, std::istream& input, std::ostrea
             return ss.str();
         });
 
+    emplace("results batch at", {STRING, STRING}, 
+        "Reads times from the first file and outputs position and velocity data at closest time calculated for each one to the second file",
+        [](Enviroment& env, std::vector<CommArgument> args) 
+        {
+            return batchQuery(env, args[0].getString(), args[1].getString(), false);
+        });
+
+    emplace("results batch interpolate", {STRING, STRING}, 
+        "Reads times from the first file and outputs position and velocity data interpolated at each one to the second file",
+        [](Enviroment& env, std::vector<CommArgument> args) 
+        {
+            return batchQuery(env, args[0].getString(), args[1].getString(), true);
+        });
+
     emplace("results reset", {}, "Deletes propagated orbit",
         [](Enviroment& env, std::vector<CommArgument> args) 
         {
@@ -316,133 +990,247 @@ void ConsoleHandler::emplace(std::string command, vector<CommArgType> argTypes,
 
 void ConsoleHandler::startQuery()
 {
-    output << "Enter command \"help\" for help" << std::endl << std::endl;;
+    output << "Enter command \"help\" for help" << std::endl << std::endl;
 
-    while(1)
+    std::string userInput;
+    while (std::getline(input, userInput))
     {
-        std::string userInput, commandString, s;
-
-        //input.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
-        getline(input, userInput);
+        ParsedLine line = parse(userInput);
 
-        std::stringstream  sstream(userInput), scommand(commandString); 
-        vector<CommArgument> args;
+        if (line.exit) // Exit program
+        {
+            output << "Exiting Orbital Calculator" << std::endl;
+            return;
+        }
 
-        bool helpCommand{false};
+        if (!line.help && line.command.empty() && line.arguments.empty())
+            continue; // Empty line
 
-        while(sstream >> s) 
+        if (line.help)
         {
-            char fC = s.front();
-
-            if (fC == '"' && s.back() == '"') // String input
-            {
-                s.erase(s.begin());
-                s.pop_back();
-                args.emplace_back(CommArgType::STRING, s);
-            }
-            else if ((fC >= '0' && fC <= '9') || fC == '-') // Is number
-            {
-                std::istringstream sstreamdouble(s);
-                double number;
-                sstreamdouble >> number;
-                args.emplace_back(CommArgType::NUMBER, number);
-            }
-            else if (s == "help" && scommand.str().empty()) // Requesting help
+            printHelp(line.command);
+        }
+        else
+        {
+            const Command* command{nullptr};
+            try
             {
-                helpCommand = true;
+                command = &find(line.command, line.arguments);
             }
-            else if (s == "exit" && scommand.str().empty()) // Exit program
+            catch (std::out_of_range& ex) // Command could not be found: does not exist
             {
-                output << "Exiting Orbital Calculator" << std::endl;
-                return;
+                output << "Command \"" << line.command << "\" not found" << std::endl;
+                output << "Do \"help\" for a list of commands" << std::endl;
             }
-            else
+            catch (std::invalid_argument& ex) // Wrong number or type of arguments
             {
-                scommand << s << " ";
+                output << ex.what() << std::endl;
             }
-        }
-        
-        commandString = scommand.str();
-        if (!commandString.empty())
-            commandString.pop_back(); // Remove trailing " "
 
-        if (helpCommand) // If requesting help
-        {
-            bool printAll{false};
-            if (!commandString.empty()) // Requesting help about command
-            { 
+            if (command)
+            {
                 try
                 {
-                    Command command = commands.at(commandString);
-
-                    output << "Usage: " << command.getCommand();
-                    for (auto type : command.getArgumentTypes())
-                    {
-                        output << " " << type;
-                    }
-                    output << std::endl << "Description: " << command.getHelp() << std::endl;
+                    output << command->call(env, std::move(line.arguments)) << std::endl;
                 }
-                catch (std::out_of_range& ex) // Command does not exist
+                catch (std::exception& ex)
                 {
-                    output << "The command \"" << commandString << "\" is not recognized." << std::endl;
-                    printAll = true;
+                    output << ex.what() << std::endl;
                 }
             }
-            else
+        }
+
+        output << std::endl;
+    }
+}
+
+namespace
+{
+    /// Command of a scenario file, checked before running any
+    struct ScriptLine
+    {
+        const std::string* path;
+        unsigned int number;
+        /// nullptr for "exit"
+        const Command* command;
+        std::vector<CommArgument> arguments;
+    };
+}
+
+int ConsoleHandler::runScripts(const std::vector<std::string>& paths)
+{
+    std::vector<ScriptLine> script;
+    int status{SCRIPT_SUCCESS};
+
+    for (const std::string& path : paths)
+    {
+        std::ifstream file{path};
+        if (!file.is_open())
+        {
+            output << "Unable to open file " << path << std::endl;
+            return SCRIPT_UNREADABLE;
+        }
+
+        std::string text;
+        unsigned int number{0};
+        while (std::getline(file, text))
+        {
+            number++;
+            const std::size_t first = text.find_first_not_of(" \t\r");
+            if (first == std::string::npos || text[first] == '#') continue;
+
+            ParsedLine line = parse(text);
+            std::string error;
+            if (line.exit)
             {
-                printAll = true;
+                script.push_back({&path, number, nullptr, {}});
+                continue;
             }
-
-            if (printAll) // print all commands
+            else if (line.help)
             {
-                output << "Do \"help\" and any of the following commands for more information:" << std::endl;
-                for (auto pair : commands)
-                {
-                    output << "  " << pair.second.getCommand() << std::endl;
-                }
+                error = "\"help\" is only available interactively";
             }
-        }
-        else // Not requesting help: rest of commands
-        {
-            try
+            else if (!line.invalidNumber.empty())
             {
-                Command command = commands.at(commandString);
-                vector<CommArgType> types = command.getArgumentTypes();
-
-                bool argsCorrect{true}; // Check if number and type of arguments is correct
-                if (types.size() != args.size())
-                {
-                    argsCorrect = false;
-                }
-                else
+                error = "\"" + line.invalidNumber + "\" is not a number";
+            }
+            else
+            {
+                try
                 {
-                    for (int i = 0; i < types.size(); i ++)
-                    {
-                        if (types[i] != args[i].getType())
-                        {   
-                            argsCorrect = false;
-                            break;
-                        }
-                    }
+                    const Command& command = find(line.command, line.arguments);
+                    script.push_back({&path, number, &command, std::move(line.arguments)});
+                    continue;
                 }
-
-                if (argsCorrect)
+                catch (std::out_of_range& ex)
                 {
-                    output << command.call(env, std::move(args)) << std::endl;
+                    error = "Command \"" + line.command + "\" not found";
                 }
-                else
+                catch (std::invalid_argument& ex)
                 {
-                    output << "Usage: " << command.getUsage() << std::endl;
+                    error = ex.what();
                 }
             }
-            catch (std::out_of_range& ex) // Command could not be found: does not exist
+
+            // Report every invalid line at once
+            output << path << ":" << number << ": " << error << std::endl;
+            status = SCRIPT_INVALID;
+        }
+
+        if (file.bad())
+        {
+            output << "Unable to read file " << path << std::endl;
+            return SCRIPT_UNREADABLE;
+        }
+    }
+
+    if (status != SCRIPT_SUCCESS)
+        return status;
+
+    for (ScriptLine& line : script)
+    {
+        if (!line.command) break; // exit
+
+        try
+        {
+            output << line.command->call(env, std::move(line.arguments)) << std::endl;
+        }
+        catch (std::exception& ex)
+        {
+            output << *line.path << ":" << line.number << ": " << ex.what() << std::endl;
+            return SCRIPT_COMMAND_FAILED;
+        }
+    }
+
+    return SCRIPT_SUCCESS;
+}
+
+ConsoleHandler::ParsedLine ConsoleHandler::parse(const std::string& line)
+{
+    ParsedLine parsed;
+    std::istringstream words(line);
+    std::string s;
+
+    while (words >> s)
+    {
+        const char fC = s.front();
+
+        if (fC == '"' && s.size() > 1 && s.back() == '"') // String input
+        {
+            parsed.arguments.emplace_back(CommArgType::STRING, s.substr(1, s.size() - 2));
+        }
+        else if ((fC >= '0' && fC <= '9') || fC == '-') // Is number
+        {
+            char* end;
+            parsed.arguments.emplace_back(CommArgType::NUMBER, std::strtod(s.c_str(), &end));
+            if ((end == s.c_str() || *end != '\0') && parsed.invalidNumber.empty())
+                parsed.invalidNumber = s;
+        }
+        else if (s == "help" && parsed.command.empty()) // Requesting help
+        {
+            parsed.help = true;
+        }
+        else if (s == "exit" && parsed.command.empty()) // Exit program
+        {
+            parsed.exit = true;
+            break;
+        }
+        else
+        {
+            if (!parsed.command.empty()) parsed.command += ' ';
+            parsed.command += s;
+        }
+    }
+
+    return parsed;
+}
+
+const Command& ConsoleHandler::find(const std::string& name, const std::vector<CommArgument>& arguments) const
+{
+    const Command& command = commands.at(name);
+    const vector<CommArgType>& types = command.getArgumentTypes();
+
+    // Check if number and type of arguments is correct
+    bool argsCorrect = types.size() == arguments.size();
+    for (std::size_t i = 0; argsCorrect && i < types.size(); i++)
+        argsCorrect = types[i] == arguments[i].getType();
+
+    if (!argsCorrect)
+        throw std::invalid_argument("Usage: " + command.getUsage());
+
+    return command;
+}
+
+void ConsoleHandler::printHelp(const std::string& name)
+{
+    bool printAll{true};
+    if (!name.empty()) // Requesting help about command
+    {
+        auto it = commands.find(name);
+        if (it != commands.end())
+        {
+            const Command& command = it->second;
+            output << "Usage: " << command.getCommand();
+            for (auto type : command.getArgumentTypes())
             {
-                output << "Command \"" << commandString << "\" not found" << std::endl;
-                output << "Do \"help\" for a list of commands" << std::endl;
+                output << " " << type;
             }
+            output << std::endl << "Description: " << command.getHelp() << std::endl;
+            printAll = false;
+        }
+        else // Command does not exist
+        {
+            output << "The command \"" << name << "\" is not recognized." << std::endl;
+        }
+    }
+
+    if (printAll) // print all commands
+    {
+        output << "Do \"help\" and any of the following commands for more information:" << std::endl;
+        for (const auto& pair : commands)
+        {
+            output << "  " << pair.second.getCommand() << std::endl;
         }
-        
-        output << std::endl;
     }
 }
 
@@ -452,22 +1240,22 @@ Command::Command(
     std::function<std::string (Enviroment&, std::vector<CommArgument>)> function) :
     command(command), argTypes(std::move(argTypes)), help(help), function(std::move(function)) {};
 
-std::string Command::getCommand()
+const std::string& Command::getCommand() const
 {
     return command;
 }
 
-std::vector<CommArgType> Command::getArgumentTypes()
+const std::vector<CommArgType>& Command::getArgumentTypes() const
 {
     return argTypes;
 }
 
-std::string Command::getHelp()
+const std::string& Command::getHelp() const
 {
     return help;
 }
 
-std::string Command::getUsage()
+std::string Command::getUsage() const
 {
     std::stringstream usage;
     usage << command;
@@ -478,9 +1266,9 @@ std::string Command::getUsage()
     return usage.str();
 }
 
-std::string Command::call(Enviroment& env, std::vector<CommArgument> arguments)
+std::string Command::call(Enviroment& env, std::vector<CommArgument> arguments) const
 {
-    return function(env, arguments);
+    return function(env, std::move(arguments));
 }
 
 /* CommArgType */
@@ -501,7 +1289,7 @@ CommArgument::CommArgument(CommArgType type, std::string userInput)
 CommArgument::CommArgument(CommArgType type, double userInput)
 : type(type), inputNumber(userInput) {};
 
-std::string CommArgument::getString()
+std::string CommArgument::getString() const
 {
     if (type != STRING)
         throw std::invalid_argument("Argument is not supposed to be a string");
@@ -509,7 +1297,7 @@ std::string CommArgument::getString()
     return inputString;
 }
 
-double CommArgument::getNumber()
+double CommArgument::getNumber() const
 {
     if (type != NUMBER)
         throw std::invalid_argument("Argument is not supposed to be a number");
@@ -517,7 +1305,7 @@ double CommArgument::getNumber()
     return inputNumber;
 }
 
-CommArgType CommArgument::getType()
+CommArgType CommArgument::getType() const
 {
     return type;
 }
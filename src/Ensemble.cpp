@@ -0,0 +1,130 @@
+#include "Ensemble.hpp"
+#include "Enviroment.hpp"
+#include <algorithm>
+#include <cmath>
+#include <sstream>
+#include <stdexcept>
+#include <thread>
+
+void Ensemble::add(const EphemerisEntry& initial, double tf, double dt)
+{
+    // Also keeps the tf/dt keys that propagate sorts by finite
+    if (!(dt > 0 && std::isfinite(dt)))
+        throw std::invalid_argument("Time step must be higher than 0");
+    if (!(tf > initial.getTime() && std::isfinite(tf)))
+        throw std::invalid_argument("Final time must be higher than the initial time");
+
+    members.push_back({initial, tf, dt, 0, {}});
+}
+
+unsigned int Ensemble::load(std::istream& is)
+{
+    unsigned int read{0}, lineNumber{0};
+    std::string line;
+
+    while (std::getline(is, line))
+    {
+        lineNumber++;
+        std::istringstream sline(line);
+        double values[8];
+        int n{0};
+        while (n < 8 && sline >> values[n]) n++;
+
+        if (n == 0 && sline.eof()) continue; // Empty line
+
+        std::string rest;
+        if (n != 8 || sline >> rest)
+            throw std::invalid_argument("Line " + std::to_string(lineNumber) + " must be: x y z vx vy vz tf dt");
+
+        try
+        {
+            add({values[0], values[1], values[2], values[3], values[4], values[5], 0}, values[6], values[7]);
+        }
+        catch (std::invalid_argument& ex)
+        {
+            throw std::invalid_argument("Line " + std::to_string(lineNumber) + ": " + ex.what());
+        }
+        read++;
+    }
+
+    return read;
+}
+
+void Ensemble::clear()
+{
+    members.clear();
+}
+
+unsigned int Ensemble::size() const
+{
+    return members.size();
+}
+
+unsigned int Ensemble::propagate(const CelestialBody& centralBody, const Perturbers& perturbers,
+                                 const Propagator& propagator, double outputStep, bool outputInterpolated,
+                                 unsigned int threads)
+{
+    if (threads == 0)
+        threads = std::max(1u, std::thread::hardware_concurrency());
+
+    if (!pool || pool->size() != threads)
+        pool.reset(new WorkStealingPool(threads));
+
+    // Longest propagations first so they do not end up last on a worker
+    std::vector<unsigned int> order(members.size());
+    for (unsigned int i = 0; i < order.size(); i++)
+        order[i] = i;
+    std::sort(order.begin(), order.end(), [this](unsigned int a, unsigned int b)
+        {
+            return members[a].tf/members[a].dt > members[b].tf/members[b].dt;
+        });
+
+    // Each task only touches its own member, so no locking is needed
+    pool->run(order, [this, &centralBody, &perturbers, &propagator, outputStep, outputInterpolated](unsigned int n)
+        {
+            Member& member = members[n];
+            Enviroment env;
+            env.setCentralBody(centralBody);
+            env.getPerturbers() = perturbers;
+            env.setPropagator(propagator.clone());
+            env.getEphemeris().setInitialEntry(member.initial);
+
+            try
+            {
+                env.setFinalTime(member.tf);
+                env.setTimeStep(member.dt);
+                env.setOutputStep(outputStep, outputInterpolated);
+                member.code = env.propagate();
+            }
+            catch (std::logic_error& ex)
+            {
+                member.code = -1;
+            }
+
+            member.ephemeris = std::move(env.getEphemeris());
+        });
+
+    return std::count_if(members.begin(), members.end(), [](const Member& m) { return m.code != 0; });
+}
+
+int Ensemble::getExitCode(unsigned int n) const
+{
+    return members.at(n).code;
+}
+
+const Ephemeris& Ensemble::getEphemeris(unsigned int n) const
+{
+    return members.at(n).ephemeris;
+}
+
+std::ostream& Ensemble::output(std::ostream& os) const
+{
+    for (const Member& member : members)
+    {
+        EphemerisEntry last = member.ephemeris.empty() ? 
+            member.initial : member.ephemeris.at(member.ephemeris.size() - 1);
+        last.output(os, false) << '\n';
+    }
+
+    return os;
+}
@@ -1,6 +1,6 @@
 #include "Enviroment.hpp"
+#include <fstream>
 #include <stdexcept>
-#include <cmath>
 
 CelestialBody& Enviroment::getCentralBody()
 {
@@ -22,16 +22,56 @@ double Enviroment::getTimeStep()
     return dt;
 }
 
+double Enviroment::getOutputStep()
+{
+    return outputStep;
+}
+
+bool Enviroment::isOutputInterpolated()
+{
+    return outputInterpolated;
+}
+
 EphemerisEntryBuilder& Enviroment::getEphemerisEntryBuilder()
 {
     return builder;
 }
 
+TextExportFormat& Enviroment::getTextExportFormat()
+{
+    return exportFormat;
+}
+
 Propagator* Enviroment::getPropagator()
 {
     return propagator.get();
 }
 
+BatchPropagator& Enviroment::getBatchPropagator()
+{
+    return batch;
+}
+
+Ensemble& Enviroment::getEnsemble()
+{
+    return ensemble;
+}
+
+Perturbers& Enviroment::getPerturbers()
+{
+    return perturbers;
+}
+
+const PropagationStats& Enviroment::getStats()
+{
+    return stats;
+}
+
+const std::string& Enviroment::getStatsFile()
+{
+    return statsFile;
+}
+
 
 void Enviroment::setCentralBody(CelestialBody central)
 {
@@ -59,39 +99,118 @@ void Enviroment::setTimeStep(double time)
     dt = time;
 }
 
+void Enviroment::setOutputStep(double time, bool interpolate)
+{
+    if (time < 0)
+        throw std::invalid_argument("Output step cannot be negative");
+
+    outputStep = time;
+    outputInterpolated = interpolate;
+}
+
 void Enviroment::setPropagator(std::unique_ptr<Propagator>&& propagator)
 {
     this->propagator = std::move(propagator);
 }
 
-// Current implementation can handle up to J3 oblateness
-MVector Enviroment::getAcceleration(EphemerisEntry entry)
+void Enviroment::setStatsFile(std::string path)
+{
+    statsFile = std::move(path);
+}
+
+Vec3 Enviroment::getAcceleration(const EphemerisEntry& entry)
+{
+    return getAcceleration(entry.getTime(), entry.getPosition());
+}
+
+Vec3 Enviroment::getAcceleration(double t, const Vec3& rv)
+{
+    return getGravityModel().getAcceleration(t, rv);
+}
+
+GravityModel Enviroment::getGravityModel()
+{
+    StatsTimer timer{StatsCounters::modelSeconds()};
+    return GravityModel(centralBody, perturbers);
+}
+
+void Enviroment::checkPerturbers()
 {
-    MVector rv = {entry.getX(), entry.getY(), entry.getZ()};
-    double r = rv.norm();
-    MVector rdd = -centralBody.getGravitationalParameter()/std::pow(r,3)*rv;
+    // Substeps of some methods fall slightly outside the propagated interval
+    if (ephemeris.empty() || perturbers.size() == 0) return;
 
-    if (centralBody.isJefferyConstantSet(2))
+    if (!perturbers.covers(ephemeris.at(0).getTime() - dt, tf + dt))
+        throw std::out_of_range("The tables of the third bodies do not cover the propagation");
+}
+
+template <class Propagation>
+int Enviroment::record(Propagation propagation)
+{
+    if constexpr (!StatsCounters::ENABLED)
     {
-        double J2 = centralBody.getJefferyConstant(2);
-        rdd[0] += J2*rdd[0]/std::pow(r,7)*(6*std::pow(rv[2],2) - 1.5*(std::pow(rv[0],2) + std::pow(rv[1],2)));
-        rdd[1] += J2*rdd[1]/std::pow(r,7)*(6*std::pow(rv[2],2) - 1.5*(std::pow(rv[0],2) + std::pow(rv[1],2)));
-        rdd[2] += J2*rdd[2]/std::pow(r,7)*(3*std::pow(rv[2],2) - 4.5*(std::pow(rv[0],2) + std::pow(rv[1],2)));
+        checkPerturbers();
+        return propagation();
     }
-
-    if (centralBody.isJefferyConstantSet(3))
+    else
     {
-        double J3 = centralBody.getJefferyConstant(3);
-        rdd[0] += J3*rdd[0]*rdd[2]/std::pow(r,9)*(10*std::pow(rv[2],2) - 7.5*(std::pow(rv[0],2) + std::pow(rv[1],2)));
-        rdd[1] += J3*rdd[1]*rdd[2]/std::pow(r,9)*(10*std::pow(rv[2],2) - 7.5*(std::pow(rv[0],2) + std::pow(rv[1],2)));
-        rdd[2] += J3/std::pow(r,9)*(4*std::pow(rdd[2],2)*(std::pow(rdd[2],2) - 3*(std::pow(rv[0],2) + std::pow(rv[1],2)) ) 
-                                    + 1.5*std::pow( (std::pow(rv[0],2) + std::pow(rv[1],2)) ,2) );
+        // Counters only grow: the run is the difference
+        PropagationStats run;
+        run.runs = stats.runs + 1;
+        const StatsCount before = StatsCounters::get();
+        {
+            StatsTimer total{run.totalSeconds};
+            {
+                StatsTimer check{run.checkSeconds};
+                checkPerturbers();
+            }
+            StatsTimer propagating{run.propagatorSeconds};
+            run.exitCode = propagation();
+        }
+        const StatsCount after = StatsCounters::get();
+
+        run.count.steps = after.steps - before.steps;
+        run.count.rejectedSteps = after.rejectedSteps - before.rejectedSteps;
+        run.count.forceEvaluations = after.forceEvaluations - before.forceEvaluations;
+        run.count.modelSeconds = after.modelSeconds - before.modelSeconds;
+        run.entries = ephemeris.size();
+        run.chunks = ephemeris.chunkCount();
+        run.ephemerisBytes = ephemeris.memoryUsage();
+        run.poolBytes = std::size_t{EphemerisChunkPool::freeBlockCount()}*EphemerisChunkPool::BLOCK_SIZE*sizeof(double);
+        stats = run;
+
+        writeStats();
+        return run.exitCode;
     }
+}
+
+void Enviroment::writeStats()
+{
+    if (statsFile.empty()) return;
 
-    return rdd;
+    std::ofstream file{statsFile, std::ios::app};
+    stats.writeJson(file) << '\n';
+    file.close();
+    if (!file)
+        throw std::runtime_error("Unable to write stats to file " + statsFile);
 }
 
 int Enviroment::propagate()
 {
-    return propagator->propagate(*this);
+    if (outputStep == 0)
+        return record([this]() { return propagator->propagate(*this); });
+
+    MemorySink sink{ephemeris};
+    return propagate(sink);
+}
+
+int Enviroment::propagate(EphemerisSink& sink)
+{
+    return record([this, &sink]()
+    {
+        if (outputStep == 0 || dt <= 0)
+            return propagator->propagate(*this, sink);
+
+        ResamplingSink resampled{sink, dt, outputStep, outputInterpolated};
+        return propagator->propagate(*this, resampled);
+    });
 }
\ No newline at end of file
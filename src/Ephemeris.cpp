@@ -1,7 +1,7 @@
 #include "Ephemeris.hpp"
 #include <stdexcept>
 #include <cmath>
-#include "MVector.hpp"
+#include <algorithm>
 
 #define M_PI 3.14159265358979323846  /* pi */
 
@@ -13,120 +13,381 @@ using std::sin;
 
 Ephemeris::Ephemeris(const Ephemeris &source)
 {
-    this->entries = source.entries;
+    *this = source;
 }
 
 Ephemeris& Ephemeris::operator=(const Ephemeris& source)
 {
     if (this == &source)
             return *this;
-    this->entries = source.entries;
+    this->chunks = source.chunks;
+    this->count = source.count;
+    this->trajectory = source.trajectory;
+    this->analyticStep = source.analyticStep;
+    this->analyticCount = source.analyticCount;
 
     return *this;
 }
 
 Ephemeris::Ephemeris(Ephemeris&& source)
 {
-    this->entries = std::move(source.entries);
+    *this = std::move(source);
 }
 
 Ephemeris& Ephemeris::operator=(Ephemeris&& source)
 {
     if (this == &source)
             return *this;
-    this->entries = std::move(source.entries);
+    this->chunks = std::move(source.chunks);
+    this->count = source.count;
+    this->trajectory = std::move(source.trajectory);
+    this->analyticStep = source.analyticStep;
+    this->analyticCount = source.analyticCount;
+    source.count = 0;
+    source.analyticCount = 0;
 
     return *this;
 }
 
-unsigned int Ephemeris::size()
+double Ephemeris::value(EphemerisColumn c, unsigned int n) const
 {
-    return entries.size();
+    return chunks[n / CHUNK]->column(static_cast<unsigned int>(c))[n % CHUNK];
 }
 
-EphemerisEntry&  Ephemeris::at(unsigned int n)
+double Ephemeris::time(unsigned int n) const
 {
-    return entries.at(n);
+    if (isAnalytic())
+        return value(EphemerisColumn::T, 0) + n*analyticStep;
+
+    return value(EphemerisColumn::T, n);
 }
 
-EphemerisEntry& Ephemeris::when(double t)
+EphemerisChunk& Ephemeris::writableChunk(unsigned int k)
 {
-    if (entries.size() < 2)
-        throw std::invalid_argument("Ephemeris has not been computed yet");
+    // Chunks may be shared with copies of this Ephemeris or be read-only: copy before writing
+    if (chunks[k].use_count() > 1 || chunks[k]->isExternal())
+        chunks[k] = std::make_shared<EphemerisChunk>(*chunks[k]);
+
+    return *chunks[k];
+}
 
-    for (int i = 1; i < entries.size(); i++)
+unsigned int Ephemeris::lowerBound(double t) const
+{
+    unsigned int first = 0, length = count;
+    while (length > 0)
     {
-        if (entries.at(i).getTime() >= t)
+        unsigned int half = length / 2;
+        if (time(first + half) < t)
+        {
+            first += half + 1;
+            length -= half + 1;
+        }
+        else
         {
-            if ((t - entries.at(i-1).getTime()) > (entries.at(i).getTime() - t))
-            {
-                return entries.at(i);
-            }
-            else
-            {
-                return entries.at(i-1);
-            }
+            length = half;
         }
     }
+    return first;
+}
 
-    return entries.back();
+unsigned int Ephemeris::upperBound(double t) const
+{
+    unsigned int first = 0, length = count;
+    while (length > 0)
+    {
+        unsigned int half = length / 2;
+        if (!(t < time(first + half)))
+        {
+            first += half + 1;
+            length -= half + 1;
+        }
+        else
+        {
+            length = half;
+        }
+    }
+    return first;
 }
 
-bool Ephemeris::empty()
+unsigned int Ephemeris::size() const
 {
-    return entries.empty();
+    return isAnalytic() ? analyticCount : count;
 }
 
-unsigned int Ephemeris::include(EphemerisEntry entry)
+EphemerisEntry Ephemeris::at(unsigned int n) const
 {
-    if (empty())
+    if (n >= size())
+        throw std::out_of_range("Ephemeris index out of range");
+
+    if (isAnalytic() && n > 0)
+        return trajectory->at(time(n));
+
+    const EphemerisChunk& chunk = *chunks[n / CHUNK];
+    unsigned int i = n % CHUNK;
+
+    return {chunk.column(1)[i], chunk.column(2)[i], chunk.column(3)[i],
+            chunk.column(4)[i], chunk.column(5)[i], chunk.column(6)[i],
+            chunk.column(0)[i]};
+}
+
+EphemerisEntry Ephemeris::when(double t) const
+{
+    if (size() < 2)
+        throw std::invalid_argument("Ephemeris has not been computed yet");
+
+    if (isAnalytic())
     {
-        entries.push_back(entry);
-        return 0;
+        // Entries are evenly spaced: round to the closest one, ties to the earlier
+        double n = std::ceil((t - time(0)) / analyticStep - 0.5);
+        return at(static_cast<unsigned int>(std::min<double>(std::max<double>(n, 0), size() - 1)));
     }
 
-    /// Most common use-case scenario, thus checked first
-    if (entries.back().getTime() < entry.getTime())
+    return at(closestIndex(lowerBound(t), t));
+}
+
+EphemerisEntry Ephemeris::interpolate(double t) const
+{
+    if (size() < 2)
+        throw std::invalid_argument("Ephemeris has not been computed yet");
+
+    if (t < time(0) || t > time(size() - 1))
+        throw std::out_of_range("Time is outside of the computed ephemeris");
+
+    if (isAnalytic())
+        return trajectory->at(t);
+
+    return interpolateSegment(segmentIndex(lowerBound(t)), t);
+}
+
+void Ephemeris::when(Span<const double> queryTimes, Span<EphemerisEntry> results, bool interpolate) const
+{
+    if (queryTimes.size() != results.size())
+        throw std::invalid_argument("There must be as many results as query times");
+
+    if (queryTimes.empty()) return;
+
+    if (size() < 2)
+        throw std::invalid_argument("Ephemeris has not been computed yet");
+
+    if (isAnalytic())
     {
-        entries.push_back(entry);
-        return entries.size() - 1;
+        // Each query is O(1), no need to sort them
+        for (unsigned int q = 0; q < queryTimes.size(); q++)
+            results[q] = interpolate ? this->interpolate(queryTimes[q]) : when(queryTimes[q]);
+        return;
     }
 
-    if (entry.getTime() < entries.at(0).getTime())
+    // Answer queries in temporal order, remembering where each one goes
+    vector<unsigned int> order(queryTimes.size());
+    for (unsigned int q = 0; q < order.size(); q++)
+        order[q] = q;
+    std::sort(order.begin(), order.end(), 
+        [&queryTimes](unsigned int a, unsigned int b) { return queryTimes[a] < queryTimes[b]; });
+
+    if (interpolate && (queryTimes[order.front()] < time(0) || queryTimes[order.back()] > time(count - 1)))
+        throw std::out_of_range("Time is outside of the computed ephemeris");
+
+    // Single forward walk over the time column: i is always the first entry with time >= t
+    unsigned int i = 0;
+    for (unsigned int q : order)
+    {
+        double t = queryTimes[q];
+        while (i < count && time(i) < t) i++;
+
+        results[q] = interpolate ? interpolateSegment(segmentIndex(i), t) : at(closestIndex(i, t));
+    }
+}
+
+unsigned int Ephemeris::closestIndex(unsigned int i, double t) const
+{
+    if (i == 0) return 0;
+    if (i == count) return count - 1;
+
+    if ((t - time(i-1)) > (time(i) - t))
+    {
+        return i;
+    }
+    else
     {
-        entries.insert(entries.begin(), entry);
-        return 0;
+        return i-1;
     }
+}
+
+unsigned int Ephemeris::segmentIndex(unsigned int i) const
+{
+    return std::min<unsigned int>(std::max<unsigned int>(i, 1), size() - 1) - 1;
+}
 
-    for (int i = 0; i < entries.size() -1; i++)
+EphemerisEntry Ephemeris::interpolateSegment(unsigned int n, double t) const
+{
+    return interpolateCubic(at(n), at(n+1), t);
+}
+
+unsigned int Ephemeris::chunkCount() const
+{
+    return chunks.size();
+}
+
+std::size_t Ephemeris::memoryUsage() const
+{
+    std::size_t bytes = chunks.capacity()*sizeof(chunks[0]);
+    for (const auto& chunk : chunks)
     {
-        if (entry.getTime() > entries.at(i).getTime())
+        bytes += sizeof(EphemerisChunk);
+        if (!chunk->isExternal())
+            bytes += EphemerisChunkPool::BLOCK_SIZE*sizeof(double);
+    }
+    return bytes;
+}
+
+Span<const double> Ephemeris::column(EphemerisColumn c, unsigned int chunk) const
+{
+    const EphemerisChunk& ch = *chunks.at(chunk);
+    return {ch.column(static_cast<unsigned int>(c)), ch.size()};
+}
+
+bool Ephemeris::empty() const
+{
+    return count == 0;
+}
+
+void Ephemeris::insertAt(unsigned int n, const EphemerisEntry& entry)
+{
+    double carry[EphemerisChunk::COLUMNS] = {entry.getTime(), entry.getX(), entry.getY(), entry.getZ(),
+                                             entry.getVx(), entry.getVy(), entry.getVz()};
+
+    // Every chunk but the last is full: shift the last entry of each
+    // chunk from the insertion point onwards into the next one
+    unsigned int offset = n % CHUNK;
+    for (unsigned int k = n / CHUNK; k < chunks.size(); k++)
+    {
+        EphemerisChunk& chunk = writableChunk(k);
+        if (!chunk.full())
         {
-            entries.insert(entries.begin() + i, entry);
-            return i+1;
+            chunk.insert(offset, carry);
+            count++;
+            return;
         }
+
+        double last[EphemerisChunk::COLUMNS];
+        chunk.pop(last);
+        chunk.insert(offset, carry);
+        std::copy(last, last + EphemerisChunk::COLUMNS, carry);
+        offset = 0;
+    }
+
+    chunks.push_back(std::make_shared<EphemerisChunk>());
+    chunks.back()->push(carry);
+    count++;
+}
+
+unsigned int Ephemeris::include(EphemerisEntry entry)
+{
+    materialize();
+
+    /// Most common use-case scenario, thus checked first
+    if (empty() || time(count - 1) < entry.getTime())
+    {
+        append(entry);
+        return size() - 1;
     }
+
+    // Place after any entry with the same or earlier time
+    unsigned int n = upperBound(entry.getTime());
+    insertAt(n, entry);
+    return n;
+}
+
+void Ephemeris::append(const EphemerisEntry& entry)
+{
+    materialize();
+
+    const double values[EphemerisChunk::COLUMNS] = {entry.getTime(), entry.getX(), entry.getY(), entry.getZ(),
+                                                    entry.getVx(), entry.getVy(), entry.getVz()};
+
+    if (chunks.empty() || chunks.back()->full())
+        chunks.push_back(std::make_shared<EphemerisChunk>());
+
+    writableChunk(chunks.size() - 1).push(values);
+    count++;
+}
+
+void Ephemeris::appendChunk(std::shared_ptr<EphemerisChunk> chunk)
+{
+    materialize();
+
+    if (!chunks.empty() && !chunks.back()->full())
+        throw std::invalid_argument("Only full chunks can be followed by another chunk");
+    if (chunk->size() == 0)
+        return;
+    if (!empty() && chunk->column(static_cast<unsigned int>(EphemerisColumn::T))[0] <= time(count - 1))
+        throw std::invalid_argument("Entries of the chunk must be later than the stored ones");
+
+    count += chunk->size();
+    chunks.push_back(std::move(chunk));
+}
+
+void Ephemeris::reserve(unsigned int n)
+{
+    materialize();
+
+    unsigned int needed = (n + CHUNK - 1) / CHUNK;
+    chunks.reserve(needed);
+
+    if (needed > chunks.size())
+        EphemerisChunkPool::reserve(needed - chunks.size());
+}
+
+void Ephemeris::setAnalytic(std::shared_ptr<const AnalyticTrajectory> trajectory, double step, unsigned int count)
+{
+    if (empty())
+        throw std::invalid_argument("An analytic ephemeris needs an initial entry");
+
+    reset();
+    this->trajectory = std::move(trajectory);
+    analyticStep = step;
+    analyticCount = std::max(count, 1u);
+}
+
+bool Ephemeris::isAnalytic() const
+{
+    return trajectory != nullptr;
+}
+
+void Ephemeris::materialize()
+{
+    if (!isAnalytic()) return;
+
+    std::shared_ptr<const AnalyticTrajectory> source = std::move(trajectory);
+    trajectory = nullptr;
+    double t0 = time(0);
+
+    reserve(analyticCount);
+    for (unsigned int n = 1; n < analyticCount; n++)
+        append(source->at(t0 + n*analyticStep));
+
+    analyticCount = 0;
 }
 
 void Ephemeris::setInitialEntry(EphemerisEntry entry)
 {
-    entries.clear();
-    entries.push_back(entry);
+    clear();
+    append(entry);
 }
 
 void Ephemeris::reset()
 {
     if (empty()) return;
 
-    EphemerisEntry initial = entries.at(0);
+    EphemerisEntry initial = at(0);
     setInitialEntry(initial);
 }
 
 std::ostream& Ephemeris::output(std::ostream &os, bool verbose)
 {
-    for (auto ent : entries)
+    for (unsigned int i = 0; i < size(); i++)
     {
-        ent.output(os, verbose) << std::endl;
+        at(i).output(os, verbose) << '\n';
     }
 
     return os;
@@ -134,7 +395,10 @@ std::ostream& Ephemeris::output(std::ostream &os, bool verbose)
 
 void Ephemeris::clear()
 {
-    entries.clear();
+    chunks.clear();
+    count = 0;
+    trajectory = nullptr;
+    analyticCount = 0;
 }
 
 /* EphemerisEntry */
@@ -147,6 +411,10 @@ double EphemerisEntry::getVy() const { return vy;}
 double EphemerisEntry::getVz() const { return vz;}
 double EphemerisEntry::getTime() const { return t;}
 
+Vec3 EphemerisEntry::getPosition() const { return {x, y, z};}
+Vec3 EphemerisEntry::getVelocity() const { return {vx, vy, vz};}
+State6 EphemerisEntry::getState() const { return {x, y, z, vx, vy, vz};}
+
 std::ostream& EphemerisEntry::output(std::ostream &os, bool verbose)
 {
     if (verbose)
@@ -175,21 +443,21 @@ EphemerisEntryBuilder::EphemerisEntryBuilder(EphemerisEntry _e, CelestialBody _b
 x(_e.getX()), y(_e.getY()), z(_e.getZ()), vx(_e.getVx()), vy(_e.getVy()), vz(_e.getVz()), 
 t(_e.getTime()), referenceBody(_b)
 {
-    MVector r{_e.getX(), _e.getY(), _e.getZ()}, v{_e.getVx(), _e.getVy(), _e.getVz()};
+    Vec3 r = _e.getPosition(), v = _e.getVelocity();
     double mu = _b.getGravitationalParameter();
 
     // Specific mechanical energy of the orbit
     double energy = pow(v.norm(), 2)/2 - mu / r.norm();
 
     // Specific angular momentum vector
-    MVector h = r%v;
+    Vec3 h = r%v;
 
     // Eccentricity vector
-    MVector ecc = (v%h) / mu - r / r.norm();
+    Vec3 ecc = (v%h) / mu - r / r.norm();
 
-    MVector zAxis = {0, 0, 1};
+    Vec3 zAxis = {0, 0, 1};
     // Ascending node vector
-    MVector n = zAxis % h;
+    Vec3 n = zAxis % h;
 
     a = -mu / 2 / energy;
     e = ecc.norm();
@@ -247,6 +515,11 @@ void EphemerisEntryBuilder::setTime(double _t)
     t = _t;
 }
 
+void EphemerisEntryBuilder::setCelestialBody(CelestialBody _b)
+{
+    referenceBody = _b;
+}
+
 bool EphemerisEntryBuilder::isValid()
 {
     if (settingCartesian)
@@ -369,3 +642,21 @@ void EphemerisEntryBuilder::output(std::ostream &os)
     if (t) os << t.value() << " seconds"; else os << "NaN";
     // os << std::endl;
 }
+
+EphemerisEntry interpolateCubic(const EphemerisEntry& s0, const EphemerisEntry& s1, double t)
+{
+    double t0 = s0.getTime(), h = s1.getTime() - t0;
+    double s = (t - t0) / h, s2 = s*s, s3 = s2*s;
+
+    // Cubic Hermite basis functions and their derivatives with respect to s
+    double h00 = 2*s3 - 3*s2 + 1, h10 = s3 - 2*s2 + s, h01 = -2*s3 + 3*s2, h11 = s3 - s2;
+    double d00 = 6*s2 - 6*s, d10 = 3*s2 - 4*s + 1, d01 = -6*s2 + 6*s, d11 = 3*s2 - 2*s;
+
+    Vec3 p0 = s0.getPosition(), v0 = s0.getVelocity();
+    Vec3 p1 = s1.getPosition(), v1 = s1.getVelocity();
+
+    Vec3 r = h00*p0 + (h10*h)*v0 + h01*p1 + (h11*h)*v1;
+    Vec3 v = (d00/h)*p0 + d10*v0 + (d01/h)*p1 + d11*v1;
+
+    return {r, v, t};
+}
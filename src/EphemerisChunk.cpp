@@ -0,0 +1,103 @@
+#include "EphemerisChunk.hpp"
+#include <algorithm>
+
+/* EphemerisChunk */
+
+EphemerisChunk::EphemerisChunk() : block(EphemerisChunkPool::acquire())
+{
+    for (unsigned int c = 0; c < COLUMNS; c++)
+        columns[c] = block + c*CAPACITY;
+}
+
+EphemerisChunk::EphemerisChunk(const double* const columns[COLUMNS], unsigned int count,
+                               std::shared_ptr<const void> storage) :
+    block(nullptr), count(count), storage(std::move(storage))
+{
+    for (unsigned int c = 0; c < COLUMNS; c++)
+        this->columns[c] = const_cast<double*>(columns[c]);
+}
+
+EphemerisChunk::~EphemerisChunk()
+{
+    if (!isExternal())
+        EphemerisChunkPool::release(block);
+}
+
+EphemerisChunk::EphemerisChunk(const EphemerisChunk& source) : EphemerisChunk()
+{
+    count = source.count;
+    for (unsigned int c = 0; c < COLUMNS; c++)
+        std::copy(source.columns[c], source.columns[c] + count, columns[c]);
+}
+
+void EphemerisChunk::push(const double values[COLUMNS])
+{
+    for (unsigned int c = 0; c < COLUMNS; c++)
+        columns[c][count] = values[c];
+    count++;
+}
+
+void EphemerisChunk::insert(unsigned int n, const double values[COLUMNS])
+{
+    for (unsigned int c = 0; c < COLUMNS; c++)
+    {
+        std::copy_backward(columns[c] + n, columns[c] + count, columns[c] + count + 1);
+        columns[c][n] = values[c];
+    }
+    count++;
+}
+
+void EphemerisChunk::pop(double values[COLUMNS])
+{
+    count--;
+    for (unsigned int c = 0; c < COLUMNS; c++)
+        values[c] = columns[c][count];
+}
+
+/* EphemerisChunkPool */
+
+std::mutex EphemerisChunkPool::mutex;
+std::vector<std::unique_ptr<double[]>> EphemerisChunkPool::freeBlocks;
+
+double* EphemerisChunkPool::acquire()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (!freeBlocks.empty())
+        {
+            double* block = freeBlocks.back().release();
+            freeBlocks.pop_back();
+            return block;
+        }
+    }
+
+    return new double[BLOCK_SIZE];
+}
+
+void EphemerisChunkPool::release(double* block)
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (freeBlocks.size() < MAX_FREE_BLOCKS)
+        {
+            freeBlocks.emplace_back(block);
+            return;
+        }
+    }
+
+    delete[] block;
+}
+
+void EphemerisChunkPool::reserve(unsigned int blocks)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    freeBlocks.reserve(blocks);
+    while (freeBlocks.size() < blocks)
+        freeBlocks.emplace_back(new double[BLOCK_SIZE]);
+}
+
+unsigned int EphemerisChunkPool::freeBlockCount()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return freeBlocks.size();
+}
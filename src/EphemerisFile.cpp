@@ -0,0 +1,297 @@
+#include "EphemerisFile.hpp"
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+constexpr char EphemerisFile::MAGIC[8];
+
+std::uint64_t EphemerisFile::hash(std::uint64_t h, const double* data, std::size_t n)
+{
+    for (std::size_t i = 0; i < n; i++)
+    {
+        std::uint64_t word;
+        std::memcpy(&word, data + i, sizeof(word));
+        h = (h ^ word) * 0x100000001b3ULL;
+    }
+    return h;
+}
+
+namespace
+{
+    const unsigned int COLUMNS = EphemerisChunk::COLUMNS;
+    const unsigned int CHUNK = EphemerisChunk::CAPACITY;
+
+    /// @return checksum of the payload from the hashes of its @param columns
+    std::uint64_t combine(const std::array<std::uint64_t, COLUMNS>& columns)
+    {
+        std::uint64_t h{EphemerisFile::HASH_OFFSET};
+        for (std::uint64_t column : columns)
+            h = (h ^ column) * 0x100000001b3ULL;
+        return h;
+    }
+
+    /// Read-only mapping of a whole file, unmapped when destroyed
+    class MappedFile
+    {
+        public:
+        MappedFile(const std::string& path)
+        {
+            int fd = ::open(path.c_str(), O_RDONLY);
+            if (fd < 0)
+                throw std::invalid_argument("Could not open file " + path);
+
+            struct stat info;
+            if (::fstat(fd, &info) != 0)
+            {
+                ::close(fd);
+                throw std::invalid_argument("Could not read file " + path);
+            }
+
+            length = static_cast<std::size_t>(info.st_size);
+            if (length > 0)
+                address = ::mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+            ::close(fd);
+
+            if (address == MAP_FAILED)
+                throw std::invalid_argument("Could not map file " + path);
+        }
+
+        ~MappedFile()
+        {
+            if (address != nullptr && address != MAP_FAILED)
+                ::munmap(address, length);
+        }
+
+        MappedFile(const MappedFile&) = delete;
+        MappedFile& operator=(const MappedFile&) = delete;
+
+        const char* data() const { return static_cast<const char*>(address); };
+        std::size_t size() const { return length; };
+
+        private:
+        void* address{nullptr};
+        std::size_t length{0};
+    };
+}
+
+/* EphemerisFileWriter */
+
+EphemerisFileWriter::EphemerisFileWriter(const std::string& path, const CelestialBody& centralBody,
+                                         double timeStep, unsigned int count) :
+    path(path), file(path, std::ios::in | std::ios::out | std::ios::binary | std::ios::trunc)
+{
+    if (!file.is_open())
+        throw std::invalid_argument("Could not open file " + path);
+
+    for (unsigned int n = 2; centralBody.isJefferyConstantSet(n); n++)
+        zonal.push_back(centralBody.getJefferyConstant(n));
+
+    std::copy(EphemerisFile::MAGIC, EphemerisFile::MAGIC + 8, header.magic);
+    header.version = EphemerisFile::VERSION;
+    header.byteOrder = EphemerisFile::BYTE_ORDER_MARK;
+    header.zonalCount = static_cast<std::uint32_t>(zonal.size());
+    header.count = count;
+    header.mu = centralBody.getGravitationalParameter();
+    header.dt = timeStep;
+
+    // The header is written last: until then the file is not valid
+    payload = sizeof(header) + zonal.size()*sizeof(double);
+    hashes.fill(EphemerisFile::HASH_OFFSET);
+    for (auto& column : buffer)
+        column.resize(CHUNK);
+}
+
+void EphemerisFileWriter::write(const EphemerisEntry& entry)
+{
+    const double values[COLUMNS] = {entry.getTime(), entry.getX(), entry.getY(), entry.getZ(),
+                                    entry.getVx(), entry.getVy(), entry.getVz()};
+    for (unsigned int c = 0; c < COLUMNS; c++)
+        buffer[c][buffered] = values[c];
+
+    if (++buffered == CHUNK)
+        flush();
+}
+
+void EphemerisFileWriter::write(const double* const columns[COLUMNS], unsigned int n)
+{
+    flush();
+    writeBlock(columns, n);
+}
+
+void EphemerisFileWriter::close()
+{
+    flush();
+    const bool truncated = written < header.count;
+    if (truncated)
+        compact();
+
+    header.checksum = combine(hashes);
+    file.seekp(0);
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    file.write(reinterpret_cast<const char*>(zonal.data()), zonal.size()*sizeof(double));
+
+    file.close();
+    if (!file)
+        throw std::invalid_argument("Could not write file " + path);
+
+    // Columns beyond the last one were written for the announced entries
+    std::error_code error;
+    if (truncated)
+        std::filesystem::resize_file(path, payload + COLUMNS*header.count*sizeof(double), error);
+    if (error)
+        throw std::invalid_argument("Could not write file " + path);
+}
+
+void EphemerisFileWriter::compact()
+{
+    // Every column moves towards the start, so copying forwards never
+    // overwrites what is still to be moved
+    std::vector<double>& block = buffer[0];
+    for (unsigned int c = 1; c < COLUMNS; c++)
+    {
+        for (std::uint64_t first = 0; first < written; first += CHUNK)
+        {
+            const std::uint64_t n = std::min<std::uint64_t>(CHUNK, written - first);
+            file.seekg(payload + static_cast<std::streamoff>((c*header.count + first)*sizeof(double)));
+            file.read(reinterpret_cast<char*>(block.data()), n*sizeof(double));
+            file.seekp(payload + static_cast<std::streamoff>((c*written + first)*sizeof(double)));
+            file.write(reinterpret_cast<const char*>(block.data()), n*sizeof(double));
+        }
+    }
+    header.count = written;
+}
+
+void EphemerisFileWriter::flush()
+{
+    if (buffered == 0) return;
+
+    const double* columns[COLUMNS];
+    for (unsigned int c = 0; c < COLUMNS; c++)
+        columns[c] = buffer[c].data();
+
+    unsigned int n = buffered;
+    buffered = 0;
+    writeBlock(columns, n);
+}
+
+void EphemerisFileWriter::writeBlock(const double* const columns[COLUMNS], unsigned int n)
+{
+    if (written + n > header.count)
+        throw std::out_of_range("More entries than announced written to " + path);
+
+    if (written == 0 && n > 0)
+        header.t0 = columns[static_cast<unsigned int>(EphemerisColumn::T)][0];
+
+    // Each column of the block goes to its place in the payload
+    for (unsigned int c = 0; c < COLUMNS; c++)
+    {
+        hashes[c] = EphemerisFile::hash(hashes[c], columns[c], n);
+        file.seekp(payload + static_cast<std::streamoff>((c*header.count + written)*sizeof(double)));
+        file.write(reinterpret_cast<const char*>(columns[c]), n*sizeof(double));
+    }
+    written += n;
+}
+
+/* EphemerisFile */
+
+void EphemerisFile::write(const std::string& path, const Ephemeris& ephemeris,
+                          const CelestialBody& centralBody, double timeStep)
+{
+    EphemerisFileWriter writer{path, centralBody, timeStep, ephemeris.size()};
+
+    if (ephemeris.isAnalytic()) // Entries are not stored: generate them
+    {
+        for (unsigned int i = 0; i < ephemeris.size(); i++)
+            writer.write(ephemeris.at(i));
+    }
+    else
+    {
+        for (unsigned int k = 0; k < ephemeris.chunkCount(); k++)
+        {
+            const double* columns[COLUMNS];
+            for (unsigned int c = 0; c < COLUMNS; c++)
+                columns[c] = ephemeris.column(static_cast<EphemerisColumn>(c), k).data();
+            writer.write(columns, ephemeris.column(EphemerisColumn::T, k).size());
+        }
+    }
+
+    writer.close();
+}
+
+EphemerisFile::EphemerisFile(const std::string& path, bool verify)
+{
+    auto mapping = std::make_shared<MappedFile>(path);
+
+    EphemerisFileHeader header;
+    if (mapping->size() < sizeof(header))
+        throw std::invalid_argument(path + " is not an ephemeris file");
+    std::memcpy(&header, mapping->data(), sizeof(header));
+
+    if (!std::equal(MAGIC, MAGIC + 8, header.magic))
+        throw std::invalid_argument(path + " is not an ephemeris file");
+    if (header.version != VERSION)
+        throw std::invalid_argument(path + " has unsupported version " + std::to_string(header.version));
+    if (header.byteOrder != BYTE_ORDER_MARK)
+        throw std::invalid_argument(path + " was written with a different byte order");
+
+    const std::size_t payload = sizeof(header) + header.zonalCount*sizeof(double);
+    if (header.count > 0xffffffffULL ||
+        mapping->size() != payload + COLUMNS*header.count*sizeof(double))
+        throw std::invalid_argument(path + " is truncated or corrupted");
+
+    centralBody.setGravitationalParameter(header.mu);
+    for (std::uint32_t n = 0; n < header.zonalCount; n++)
+    {
+        double constant;
+        std::memcpy(&constant, mapping->data() + sizeof(header) + n*sizeof(double), sizeof(double));
+        centralBody.setJefferyConstant(n + 2, constant);
+    }
+    timeStep = header.dt;
+
+    // Payload offset is a multiple of 8 and the mapping is page aligned
+    const double* columns = reinterpret_cast<const double*>(mapping->data() + payload);
+    const unsigned int count = static_cast<unsigned int>(header.count);
+
+    if (verify)
+    {
+        std::array<std::uint64_t, COLUMNS> hashes;
+        for (unsigned int c = 0; c < COLUMNS; c++)
+            hashes[c] = hash(HASH_OFFSET, columns + c*header.count, count);
+        if (combine(hashes) != header.checksum)
+            throw std::invalid_argument(path + " fails the checksum");
+    }
+
+    for (unsigned int first = 0; first < count; first += CHUNK)
+    {
+        const double* chunkColumns[COLUMNS];
+        for (unsigned int c = 0; c < COLUMNS; c++)
+            chunkColumns[c] = columns + c*header.count + first;
+
+        ephemeris.appendChunk(std::make_shared<EphemerisChunk>(
+            chunkColumns, std::min(CHUNK, count - first), mapping));
+    }
+}
+
+const Ephemeris& EphemerisFile::getEphemeris() const
+{
+    return ephemeris;
+}
+
+const CelestialBody& EphemerisFile::getCentralBody() const
+{
+    return centralBody;
+}
+
+double EphemerisFile::getTimeStep() const
+{
+    return timeStep;
+}
@@ -0,0 +1,148 @@
+#include "EphemerisSink.hpp"
+#include "EphemerisFile.hpp"
+#include "TextExporter.hpp"
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+/* MemorySink */
+
+void MemorySink::begin(const EphemerisEntry& initial, unsigned int count)
+{
+    ephemeris.setInitialEntry(initial);
+    ephemeris.reserve(count);
+}
+
+void MemorySink::append(const EphemerisEntry& entry)
+{
+    ephemeris.append(entry);
+}
+
+/* ResamplingSink */
+
+ResamplingSink::ResamplingSink(EphemerisSink& target, double timeStep, double outputStep, bool interpolate) :
+    target(target), timeStep(timeStep), outputStep(outputStep), interpolate(interpolate)
+{
+    if (timeStep <= 0 || outputStep <= 0)
+        throw std::invalid_argument("Time step and output step must be higher than 0");
+
+    stride = static_cast<unsigned int>(std::max(1.0, std::round(outputStep / timeStep)));
+}
+
+void ResamplingSink::begin(const EphemerisEntry& initial, unsigned int count)
+{
+    previous = initial;
+    t0 = initial.getTime();
+    next = 1;
+    skipped = 0;
+
+    if (!interpolate)
+    {
+        target.begin(initial, (count - 1) / stride + 1);
+        return;
+    }
+
+    // Times of the entries accumulate as in the propagators, epochs
+    // are computed as in append: count those up to the last entry
+    double last{t0};
+    for (unsigned int i = 1; i < count; i++)
+        last += timeStep;
+
+    unsigned int epochs{1};
+    while (t0 + epochs*outputStep <= last)
+        epochs++;
+
+    remaining = epochs - 1;
+    target.begin(initial, epochs);
+}
+
+void ResamplingSink::append(const EphemerisEntry& entry)
+{
+    if (!interpolate)
+    {
+        if (++skipped == stride)
+        {
+            target.append(entry);
+            skipped = 0;
+        }
+        return;
+    }
+
+    while (remaining > 0 && t0 + next*outputStep <= entry.getTime())
+    {
+        double epoch = t0 + next*outputStep;
+        target.append(epoch == entry.getTime() ? entry : interpolateCubic(previous, entry, epoch));
+        next++;
+        remaining--;
+    }
+    previous = entry;
+}
+
+void ResamplingSink::end()
+{
+    target.end();
+}
+
+/* CallbackSink */
+
+void CallbackSink::begin(const EphemerisEntry& initial, unsigned int)
+{
+    callback(initial);
+}
+
+void CallbackSink::append(const EphemerisEntry& entry)
+{
+    callback(entry);
+}
+
+/* TextFileSink */
+
+TextFileSink::TextFileSink(const std::string& path) : path(path), file(path, std::ios::binary | std::ios::trunc)
+{
+    if (!file.is_open())
+        throw std::invalid_argument("Could not open file " + path);
+    exporter.reset(new TextExporter(file, TextExportFormat::ephemerisOutput()));
+}
+
+TextFileSink::~TextFileSink() {};
+
+void TextFileSink::begin(const EphemerisEntry& initial, unsigned int)
+{
+    exporter->write(initial);
+}
+
+void TextFileSink::append(const EphemerisEntry& entry)
+{
+    exporter->write(entry);
+}
+
+void TextFileSink::end()
+{
+    exporter.reset();
+    file.close();
+    if (!file)
+        throw std::invalid_argument("Could not write file " + path);
+}
+
+/* BinaryFileSink */
+
+BinaryFileSink::BinaryFileSink(const std::string& path, const CelestialBody& centralBody, double timeStep) :
+    path(path), centralBody(centralBody), timeStep(timeStep) {};
+
+BinaryFileSink::~BinaryFileSink() {};
+
+void BinaryFileSink::begin(const EphemerisEntry& initial, unsigned int count)
+{
+    writer.reset(new EphemerisFileWriter(path, centralBody, timeStep, count));
+    writer->write(initial);
+}
+
+void BinaryFileSink::append(const EphemerisEntry& entry)
+{
+    writer->write(entry);
+}
+
+void BinaryFileSink::end()
+{
+    writer->close();
+}
@@ -0,0 +1,294 @@
+#include "GravityField.hpp"
+#include <algorithm>
+#include <cmath>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+
+namespace
+{
+    /// @return value of @param token, which may have a Fortran exponent (1.0D-06)
+    double parseNumber(std::string token, unsigned int lineNumber)
+    {
+        std::replace(token.begin(), token.end(), 'D', 'E');
+        std::replace(token.begin(), token.end(), 'd', 'E');
+
+        std::size_t read{0};
+        double value{0};
+        try
+        {
+            value = std::stod(token, &read);
+        }
+        catch(std::exception&)
+        {
+        }
+
+        if (read == 0 || read != token.size())
+            throw std::invalid_argument("Line " + std::to_string(lineNumber) + ": \"" + token + "\" is not a number");
+
+        return value;
+    }
+
+    struct Coefficient
+    {
+        unsigned int n, m;
+        double C, S;
+    };
+}
+
+/* GravityField */
+
+GravityField::GravityField(double mu, double radius, unsigned int maxDegree) :
+    mu(mu), radius(radius), maxDegree(maxDegree),
+    C(index(maxDegree, maxDegree) + 1, 0), S(index(maxDegree, maxDegree) + 1, 0)
+{
+    if (mu <= 0 || radius <= 0)
+        throw std::invalid_argument("The gravitational parameter and radius of a field must be positive");
+}
+
+GravityField GravityField::read(std::istream& is)
+{
+    double mu{0}, radius{0};
+    bool header{true};
+    unsigned int lineNumber{0}, maxDegree{0};
+    std::vector<Coefficient> coefficients;
+    std::string line;
+
+    while (std::getline(is, line))
+    {
+        lineNumber++;
+        std::istringstream sline(line);
+        std::string key;
+        if (!(sline >> key)) continue; // Empty line
+
+        if (header)
+        {
+            std::string value;
+            sline >> value;
+
+            if (key == "end_of_head") header = false;
+            else if (key == "earth_gravity_constant") mu = parseNumber(value, lineNumber)/1e9;
+            else if (key == "radius") radius = parseNumber(value, lineNumber)/1e3;
+            else if (key == "norm" && value != "fully_normalized")
+                throw std::invalid_argument("Only fully normalized coefficients are supported");
+
+            continue;
+        }
+
+        if (key != "gfc")
+            throw std::invalid_argument("Line " + std::to_string(lineNumber) + ": only gfc coefficients are supported");
+
+        std::string values[4];
+        for (std::string& value : values)
+        {
+            if (!(sline >> value))
+                throw std::invalid_argument("Line " + std::to_string(lineNumber) + " must be: gfc n m C S");
+        }
+
+        double n = parseNumber(values[0], lineNumber), m = parseNumber(values[1], lineNumber);
+        if (n < 0 || m < 0 || m > n || n != std::floor(n) || m != std::floor(m))
+            throw std::invalid_argument("Line " + std::to_string(lineNumber) + ": invalid degree and order");
+
+        coefficients.push_back({static_cast<unsigned int>(n), static_cast<unsigned int>(m),
+                                parseNumber(values[2], lineNumber), parseNumber(values[3], lineNumber)});
+        maxDegree = std::max(maxDegree, coefficients.back().n);
+    }
+
+    if (header)
+        throw std::invalid_argument("The file has no end_of_head line");
+    if (mu <= 0 || radius <= 0)
+        throw std::invalid_argument("The header must give earth_gravity_constant and radius");
+
+    GravityField field{mu, radius, maxDegree};
+    for (const Coefficient& c : coefficients)
+        field.setCoefficients(c.n, c.m, c.C, c.S);
+
+    return field;
+}
+
+double GravityField::getGravitationalParameter() const
+{
+    return mu;
+}
+
+double GravityField::getRadius() const
+{
+    return radius;
+}
+
+unsigned int GravityField::getMaxDegree() const
+{
+    return maxDegree;
+}
+
+void GravityField::setCoefficients(unsigned int n, unsigned int m, double C, double S)
+{
+    std::size_t i = checkedIndex(n, m);
+    this->C[i] = C;
+    this->S[i] = S;
+}
+
+double GravityField::getC(unsigned int n, unsigned int m) const
+{
+    return C[checkedIndex(n, m)];
+}
+
+double GravityField::getS(unsigned int n, unsigned int m) const
+{
+    return S[checkedIndex(n, m)];
+}
+
+std::size_t GravityField::checkedIndex(unsigned int n, unsigned int m) const
+{
+    if (m > n || n > maxDegree)
+        throw std::out_of_range("No coefficient of degree " + std::to_string(n) + " and order " + std::to_string(m));
+
+    return index(n, m);
+}
+
+/* GravityFieldEvaluator */
+
+GravityFieldEvaluator::GravityFieldEvaluator(const GravityField& field, unsigned int degree, unsigned int order) :
+    degree(degree), order(order), radius(field.getRadius()),
+    scale(field.getGravitationalParameter()/(field.getRadius()*field.getRadius()))
+{
+    if (degree > field.getMaxDegree())
+        throw std::invalid_argument("The field only has coefficients up to degree " + std::to_string(field.getMaxDegree()));
+    if (order > degree)
+        throw std::invalid_argument("The order cannot be greater than the degree");
+
+    // Orders 0 to degree + 1, each with degrees up to degree + 1
+    const unsigned int N = degree + 1;
+    offsets.assign(N + 2, 0);
+    for (unsigned int m = 0; m <= N; m++)
+        offsets[m + 1] = offsets[m] + (N + 1 - m);
+
+    const std::size_t size = offsets[N + 1];
+    auto at = [this](unsigned int n, unsigned int m) { return offsets[m] + (n - m); };
+
+    C.assign(size, 0);
+    S.assign(size, 0);
+    upper.assign(size, 0);
+    lower.assign(size, 0);
+    vertical.assign(size, 0);
+
+    // Ratios between the normalization of each coefficient and of the V and W of degree n + 1 it multiplies
+    for (unsigned int m = 0; m <= order; m++)
+    {
+        for (unsigned int n = std::max(m, 2u); n <= degree; n++)
+        {
+            const std::size_t i = at(n, m);
+            const double q = (2.0*n + 1)/(2.0*n + 3);
+            C[i] = field.getC(n, m);
+            S[i] = field.getS(n, m);
+            vertical[i] = std::sqrt(q*(n + m + 1)*(n - m + 1));
+
+            if (m == 0)
+            {
+                upper[i] = std::sqrt(q*(n + 1)*(n + 2)/2);
+            }
+            else
+            {
+                upper[i] = std::sqrt(q*(n + m + 1)*(n + m + 2))/2;
+                lower[i] = std::sqrt(q*(n - m + 1)*(n - m + 2)*(m == 1 ? 2 : 1))/2;
+            }
+        }
+    }
+
+    // Normalized recursions: Vmm from V(m-1)(m-1) and Vnm from V(n-1)m and V(n-2)m
+    sectoral.assign(N + 1, 0);
+    for (unsigned int m = 1; m <= N; m++)
+        sectoral[m] = std::sqrt((2*m + 1)/(2.0*m)*(m == 1 ? 2 : 1));
+
+    zonalA.assign(size, 0);
+    zonalB.assign(size, 0);
+    for (unsigned int m = 0; m <= N; m++)
+    {
+        for (unsigned int n = m + 1; n <= N; n++)
+        {
+            const double n2 = 2.0*n;
+            zonalA[at(n, m)] = std::sqrt((n2 - 1)*(n2 + 1)/((n - m)*double(n + m)));
+            zonalB[at(n, m)] = std::sqrt((n2 + 1)*(n + m - 1.0)*(n - m - 1.0)/((n2 - 3)*(n + m)*(n - m)));
+        }
+    }
+
+    V.assign(size, 0);
+    W.assign(size, 0);
+}
+
+Vec3 GravityFieldEvaluator::getAcceleration(const Vec3& position) const
+{
+    if (degree < 2) return {};
+
+    const double r2 = position[0]*position[0] + position[1]*position[1] + position[2]*position[2];
+    const double rho = radius/r2;
+    const double x0 = position[0]*rho, y0 = position[1]*rho, z0 = position[2]*rho;
+    const double rr = radius*rho;
+
+    // V and W of every order needed, each column from its sectoral term down
+    const unsigned int N = degree + 1, M = std::min(order + 1, N);
+    for (unsigned int m = 0; m <= M; m++)
+    {
+        double* v = V.data() + offsets[m];
+        double* w = W.data() + offsets[m];
+        const double* a = zonalA.data() + offsets[m];
+        const double* b = zonalB.data() + offsets[m];
+
+        if (m == 0)
+        {
+            v[0] = radius/std::sqrt(r2);
+            w[0] = 0;
+        }
+        else
+        {
+            const double* vPrevious = V.data() + offsets[m - 1];
+            const double* wPrevious = W.data() + offsets[m - 1];
+            v[0] = sectoral[m]*(x0*vPrevious[0] - y0*wPrevious[0]);
+            w[0] = sectoral[m]*(x0*wPrevious[0] + y0*vPrevious[0]);
+        }
+
+        if (m == N) break;
+
+        v[1] = a[1]*z0*v[0];
+        w[1] = a[1]*z0*w[0];
+        for (unsigned int k = 2; k <= N - m; k++)
+        {
+            v[k] = a[k]*z0*v[k - 1] - b[k]*rr*v[k - 2];
+            w[k] = a[k]*z0*w[k - 1] - b[k]*rr*w[k - 2];
+        }
+    }
+
+    // Terms of order 0 need V and W of degree n + 1 and orders 0 and 1
+    double ax{0}, ay{0}, az{0};
+    {
+        const double* c = C.data();
+        const double *v = V.data(), *v1 = V.data() + offsets[1], *w1 = W.data() + offsets[1];
+        for (unsigned int n = 2; n <= degree; n++)
+        {
+            ax -= upper[n]*c[n]*v1[n];
+            ay -= upper[n]*c[n]*w1[n];
+            az -= vertical[n]*c[n]*v[n + 1];
+        }
+    }
+
+    // Terms of order m need those of degree n + 1 and orders m - 1, m and m + 1
+    for (unsigned int m = 1; m <= order; m++)
+    {
+        const std::size_t o = offsets[m];
+        const double *c = C.data() + o, *s = S.data() + o;
+        const double *up = upper.data() + o, *low = lower.data() + o, *vert = vertical.data() + o;
+        const double *v = V.data() + o, *w = W.data() + o;
+        const double *vLow = V.data() + offsets[m - 1] + 2, *wLow = W.data() + offsets[m - 1] + 2;
+        const double *vUp = V.data() + offsets[m + 1], *wUp = W.data() + offsets[m + 1];
+
+        // k = n - m: degree n + 1 is at k + 1 in order m, k + 2 in order m - 1 and k in order m + 1
+        for (unsigned int k = (m < 2 ? 2 - m : 0); k <= degree - m; k++)
+        {
+            ax += up[k]*(-c[k]*vUp[k] - s[k]*wUp[k]) + low[k]*(c[k]*vLow[k] + s[k]*wLow[k]);
+            ay += up[k]*(-c[k]*wUp[k] + s[k]*vUp[k]) + low[k]*(-c[k]*wLow[k] + s[k]*vLow[k]);
+            az += vert[k]*(-c[k]*v[k + 1] - s[k]*w[k + 1]);
+        }
+    }
+
+    return scale*Vec3{ax, ay, az};
+}
@@ -0,0 +1,33 @@
+#include "GravityModel.hpp"
+
+GravityModel::GravityModel() : kernel(&zonalAcceleration<false, false>)
+{
+}
+
+GravityModel::GravityModel(const CelestialBody& body, const Perturbers& perturbers)
+{
+    parameters.mu = body.getGravitationalParameter();
+
+    for (const ThirdBody& thirdBody : perturbers.getBodies())
+        thirdBodies.emplace_back(thirdBody, perturbers.getEpoch());
+
+    if (body.getGravityField() != nullptr)
+    {
+        kernel = &zonalAcceleration<false, false>;
+        hasField = true;
+        epoch = perturbers.getEpoch();
+        field = GravityFieldEvaluator(*body.getGravityField(), body.getGravityFieldDegree(), body.getGravityFieldOrder());
+        return;
+    }
+
+    const bool J2 = body.isJefferyConstantSet(2);
+    const bool J3 = body.isJefferyConstantSet(3);
+
+    parameters.K2 = J2 ? body.getJefferyConstant(2) : 0;
+    parameters.K3 = J3 ? body.getJefferyConstant(3) : 0;
+
+    if (J2 && J3) kernel = &zonalAcceleration<true, true>;
+    else if (J2) kernel = &zonalAcceleration<true, false>;
+    else if (J3) kernel = &zonalAcceleration<false, true>;
+    else kernel = &zonalAcceleration<false, false>;
+}
@@ -0,0 +1,177 @@
+#include "KeplerPropagator.hpp"
+#include "Enviroment.hpp"
+#include <cmath>
+
+namespace
+{
+    const double PI = 3.14159265358979323846;
+
+    /** Stumpff functions c2 and c3 of @param psi. Below |psi| = 1 their series
+     *  are used, since the closed forms lose most digits to cancellation there.
+     */
+    void stumpff(double psi, double& c2, double& c3)
+    {
+        if (psi > 1)
+        {
+            double s = std::sqrt(psi);
+            c2 = (1 - std::cos(s)) / psi;
+            c3 = (s - std::sin(s)) / (psi*s);
+        }
+        else if (psi < -1)
+        {
+            double s = std::sqrt(-psi);
+            c2 = (std::cosh(s) - 1) / -psi;
+            c3 = (std::sinh(s) - s) / (-psi*s);
+        }
+        else
+        {
+            // c2 = sum (-psi)^k/(2k+2)!, c3 = sum (-psi)^k/(2k+3)!
+            double term2{0.5}, term3{1.0/6};
+            c2 = term2;
+            c3 = term3;
+            for (int k = 1; k < 12; k++)
+            {
+                term2 *= -psi / ((2*k + 1)*(2*k + 2));
+                term3 *= -psi / ((2*k + 2)*(2*k + 3));
+                c2 += term2;
+                c3 += term3;
+            }
+        }
+    }
+}
+
+/* KeplerOrbit */
+
+KeplerOrbit::KeplerOrbit(const EphemerisEntry& initial, double mu) :
+    r0(initial.getPosition()), v0(initial.getVelocity()), t0(initial.getTime()), mu(mu)
+{
+    r0Norm = r0.norm();
+    sigma0 = r0*v0 / std::sqrt(mu);
+    alpha = 2/r0Norm - v0.squaredNorm()/mu;
+
+    if (alpha > 0)
+        period = 2*PI / std::sqrt(mu*alpha*alpha*alpha);
+}
+
+EphemerisEntry KeplerOrbit::at(double t) const
+{
+    // Whole revolutions do not change the state, removing them keeps the
+    // universal anomaly small and the error independent of the elapsed time
+    double dt = period > 0 ? std::remainder(t - t0, period) : t - t0;
+    if (dt == 0)
+        return {r0, v0, t};
+
+    double sqrtMu = std::sqrt(mu);
+
+    // Initial guess of the universal anomaly chi
+    double chi;
+    if (alpha > 1e-9)
+    {
+        chi = sqrtMu*dt*alpha;
+    }
+    else if (alpha < -1e-9)
+    {
+        double a = 1/alpha, sign = dt > 0 ? 1 : -1;
+        chi = sign*std::sqrt(-a)*std::log(-2*mu*alpha*dt /
+              (r0*v0 + sign*std::sqrt(-mu*a)*(1 - r0Norm*alpha)));
+    }
+    else
+    {
+        chi = sqrtMu*dt/r0Norm;
+    }
+
+    // Newton iterations on the universal Kepler equation
+    double psi{0}, c2{0.5}, c3{1.0/6}, r{r0Norm};
+    for (int i = 0; i < 50; i++)
+    {
+        psi = chi*chi*alpha;
+        stumpff(psi, c2, c3);
+        r = chi*chi*c2 + sigma0*chi*(1 - psi*c3) + r0Norm*(1 - psi*c2);
+        double delta = (sqrtMu*dt - chi*chi*chi*c3 - sigma0*chi*chi*c2 - r0Norm*chi*(1 - psi*c3)) / r;
+        chi += delta;
+        if (std::abs(delta) <= 1e-14*std::abs(chi)) break;
+    }
+
+    psi = chi*chi*alpha;
+    stumpff(psi, c2, c3);
+    r = chi*chi*c2 + sigma0*chi*(1 - psi*c3) + r0Norm*(1 - psi*c2);
+
+    // Lagrange coefficients
+    double f = 1 - chi*chi*c2/r0Norm;
+    double g = dt - chi*chi*chi*c3/sqrtMu;
+    double fdot = sqrtMu/(r*r0Norm)*chi*(psi*c3 - 1);
+    double gdot = 1 - chi*chi*c2/r;
+
+    return {f*r0 + g*v0, fdot*r0 + gdot*v0, t};
+}
+
+/* KeplerPropagator */
+
+int KeplerPropagator::propagate(Enviroment& env)
+{
+    const CelestialBody& body = env.getCentralBody();
+    if (body.getGravitationalParameter() == 0) return 2;
+    if (body.isJefferyConstantSet(2) || body.getGravityField() != nullptr || env.getPerturbers().size() > 0) return 4;
+
+    Ephemeris& eph = env.getEphemeris();
+
+    if (eph.empty()) return 1;
+
+    eph.reset();
+
+    EphemerisEntry initial = eph.at(0);
+    double t{initial.getTime()}, tf{env.getFinalTime()}, dt{env.getTimeStep()};
+
+    if (t >= tf - dt) return 3;
+
+    eph.setAnalytic(std::make_shared<KeplerOrbit>(initial, body.getGravitationalParameter()), dt, 
+                    countSteps(t, tf, dt) + 1);
+    return 0;
+}
+
+int KeplerPropagator::propagate(Enviroment& env, EphemerisSink& sink)
+{
+    const CelestialBody& body = env.getCentralBody();
+    if (body.getGravitationalParameter() == 0) return 2;
+    if (body.isJefferyConstantSet(2) || body.getGravityField() != nullptr || env.getPerturbers().size() > 0) return 4;
+
+    const Ephemeris& eph = env.getEphemeris();
+
+    if (eph.empty()) return 1;
+
+    EphemerisEntry initial = eph.at(0);
+    double t{initial.getTime()}, tf{env.getFinalTime()}, dt{env.getTimeStep()};
+
+    if (t >= tf - dt) return 3;
+
+    sink.begin(initial, countSteps(t, tf, dt) + 1);
+
+    KeplerOrbit orbit{initial, body.getGravitationalParameter()};
+    while (t < tf - dt)
+    {
+        t += dt;
+        StatsCounters::countStep();
+        sink.append(orbit.at(t));
+    }
+
+    sink.end();
+    return 0;
+}
+
+std::string KeplerPropagator::getExitMessage(int i)
+{
+    switch(i)
+    {
+        case 0: return "Propagation succesful";
+        case 1: return "No initial position has been set";
+        case 2: return "Central body has not been defined";
+        case 3: return "Final time or time step have not been set";
+        case 4: return "Central body has zonal terms or a gravity field, or there are third bodies, use a numerical propagator";
+    }
+    return "Unknown exit code";
+}
+
+std::unique_ptr<Propagator> KeplerPropagator::clone() const
+{
+    return std::unique_ptr<Propagator>(new KeplerPropagator(*this));
+}
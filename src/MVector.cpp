@@ -79,56 +79,6 @@ MVector& MVector::operator=(MVector&& source)
     return *this;
 }
 
-MVector MVector::operator+() const
-{
-    return *this;
-}
-
-MVector MVector::operator+(const MVector& other) const
-{
-    if (_size != other._size)
-        throw std::invalid_argument("Vector size must coincide");
-
-    MVector result(_size, false);
-    for (int i = 0; i < _size; i++)
-        result[i] = (*this)[i] + other[i];
-    
-    return std::move(result);
-}
-
-MVector MVector::operator-() const
-{
-    MVector result(_size, false);
-    for (int i = 0; i < _size; i++)
-        result[i] = -(*this)[i];
-    
-    return std::move(result);
-}
-
-MVector MVector::operator-(const MVector& other) const
-{
-    if (_size != other._size)
-        throw std::invalid_argument("Vector size must coincide");
-
-    MVector result(_size, false);
-    for (int i = 0; i < _size; i++)
-        result[i] = (*this)[i] - other[i];
-    
-    return std::move(result);
-}
-
-double MVector::operator*(const MVector& other) const
-{
-    if (_size != other._size)
-        throw std::invalid_argument("Vector size must coincide");
-
-    double result{0};
-    for (int i = 0; i < _size; i++)
-        result += (*this)[i] * other[i];
-    
-    return result;
-}
-
 MVector MVector::operator%(const MVector& other) const
 {
     if (_size != other._size || _size != 3)
@@ -142,22 +92,6 @@ MVector MVector::operator%(const MVector& other) const
     return std::move(result);
 }
 
-MVector MVector::operator*(double multiplier) const
-{
-    MVector result(_size, false);
-    for (int i = 0; i < _size; i++)
-        result[i] = (*this)[i] * multiplier;
-    return std::move(result);
-}
-
-MVector MVector::operator/(double divider) const
-{
-    MVector result(_size, false);
-    for (int i = 0; i < _size; i++)
-        result[i] = (*this)[i] / divider;
-    return std::move(result);
-}
-
 bool MVector::operator==(const MVector& other) const
 {
     if (this->_size != other._size) return false;
@@ -193,19 +127,6 @@ unsigned int MVector::size() const
     return _size;
 }
 
-MVector operator*(double multiplier, const MVector& v)
-{
-    return std::move(v*multiplier);
-}
-
-MVector operator/(double divided, const MVector& v)
-{
-    MVector result(v.size());
-    for (int i = 0; i < v.size(); i++)
-        result[i] = divided / v[i];
-    return std::move(result);
-}
-
 std::ostream &operator<<(std::ostream &os, const MVector &v)
 { 
     for (int i = 0; i < v.size(); i++)
@@ -0,0 +1,269 @@
+#include "MultistepPropagator.hpp"
+#include "Enviroment.hpp"
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+    /// Runge-Kutta 4 substeps per step while starting the history
+    const unsigned int STARTUP_SUBSTEPS = 8;
+
+    /// Number of coefficients of each backward difference formula
+    const unsigned int TERMS = 11;
+
+    /** Coefficients of the backward difference formulas, from their generating
+     *  functions (Henrici, "Discrete variable methods in ordinary differential equations"):
+     *  Adams-Moulton  -t/ln(1-t), Adams-Bashforth  -t/((1-t)ln(1-t)),
+     *  Cowell  t^2/ln(1-t)^2 and Stormer  t^2/((1-t)ln(1-t)^2)
+     */
+    struct DifferenceCoefficients
+    {
+        double adamsMoulton[TERMS], adamsBashforth[TERMS], cowell[TERMS], stormer[TERMS];
+
+        DifferenceCoefficients()
+        {
+            // Adams-Moulton is the reciprocal of -ln(1-t)/t = sum t^k/(k+1)
+            for (unsigned int n = 0; n < TERMS; n++)
+            {
+                adamsMoulton[n] = n == 0 ? 1 : 0;
+                for (unsigned int k = 1; k <= n; k++)
+                    adamsMoulton[n] -= adamsMoulton[n - k] / (k + 1);
+            }
+
+            // Dividing by 1-t accumulates, squaring convolves
+            for (unsigned int n = 0; n < TERMS; n++)
+            {
+                cowell[n] = 0;
+                for (unsigned int k = 0; k <= n; k++)
+                    cowell[n] += adamsMoulton[k]*adamsMoulton[n - k];
+
+                adamsBashforth[n] = adamsMoulton[n] + (n > 0 ? adamsBashforth[n - 1] : 0);
+                stormer[n] = cowell[n] + (n > 0 ? stormer[n - 1] : 0);
+            }
+        }
+    };
+
+    const DifferenceCoefficients coefficients;
+
+    /// @return derivative of state @param y at time @param t: velocity and acceleration
+    State6 derivative(const GravityModel& gravity, double t, const State6& y)
+    {
+        Vec3 a = gravity.getAcceleration(t, Vec3{y[0], y[1], y[2]});
+        return {y[3], y[4], y[5], a[0], a[1], a[2]};
+    }
+
+    /// @return @param state advanced by @param h with Runge-Kutta 4 substeps, labelled with time @param t
+    EphemerisEntry rungeKutta4(const GravityModel& gravity, const EphemerisEntry& state, double h, double t)
+    {
+        State6 y = state.getState();
+        double sub = h / STARTUP_SUBSTEPS;
+
+        for (unsigned int i = 0; i < STARTUP_SUBSTEPS; i++)
+        {
+            const double ti = state.getTime() + i*sub;
+            State6 k1 = derivative(gravity, ti, y);
+            State6 k2 = derivative(gravity, ti + sub/2, y + k1*(sub/2));
+            State6 k3 = derivative(gravity, ti + sub/2, y + k2*(sub/2));
+            State6 k4 = derivative(gravity, ti + sub, y + k3*sub);
+            y = y + (k1 + 2*k2 + 2*k3 + k4)*(sub/6);
+        }
+
+        return {y[0], y[1], y[2], y[3], y[4], y[5], t};
+    }
+
+    /// Replaces @param differences by those one step later, given the newest @param value
+    template <typename T, std::size_t N>
+    void advanceDifferences(std::array<T, N>& differences, const T& value)
+    {
+        T previous = differences[0];
+        differences[0] = value;
+        for (unsigned int j = 1; j < differences.size(); j++)
+        {
+            T current = differences[j];
+            differences[j] = differences[j - 1] - previous;
+            previous = current;
+        }
+    }
+}
+
+/* MultistepPropagator */
+
+int MultistepPropagator::propagate(Enviroment& env, EphemerisSink& sink)
+{
+    if (env.getCentralBody().getGravitationalParameter() == 0) return 2;
+
+    const Ephemeris& eph = env.getEphemeris();
+
+    if (eph.empty()) return 1;
+
+    EphemerisEntry state = eph.at(0);
+    double t{state.getTime()}, tf{env.getFinalTime()}, dt{env.getTimeStep()};
+
+    if (t >= tf - dt) return 3;
+
+    sink.begin(state, countSteps(t, tf, dt) + 1);
+
+    std::array<EphemerisEntry, POINTS> states;
+    std::array<Vec3, POINTS> accelerations;
+    const GravityModel gravity = env.getGravityModel();
+    states[0] = state;
+    accelerations[0] = gravity.getAcceleration(state.getTime(), state.getPosition());
+    unsigned int points{1};
+
+    auto nextRestart = std::upper_bound(restartTimes.begin(), restartTimes.end(), t);
+
+    while (t < tf - dt)
+    {
+        t += dt;
+
+        if (points < POINTS)
+        {
+            state = rungeKutta4(gravity, state, dt, t);
+            states[points] = state;
+            accelerations[points] = gravity.getAcceleration(t, state.getPosition());
+            if (++points == POINTS)
+                start(states, accelerations, dt);
+        }
+        else
+        {
+            state = step(gravity, t);
+        }
+
+        StatsCounters::countStep();
+        sink.append(state);
+
+        if (nextRestart != restartTimes.end() && *nextRestart <= t)
+        {
+            while (nextRestart != restartTimes.end() && *nextRestart <= t) ++nextRestart;
+            states[0] = state;
+            accelerations[0] = gravity.getAcceleration(state.getTime(), state.getPosition());
+            points = 1;
+        }
+    }
+
+    sink.end();
+    return 0;
+}
+
+std::string MultistepPropagator::getExitMessage(int i)
+{
+    switch(i)
+    {
+        case 0: return "Propagation succesful";
+        case 1: return "No initial position has been set";
+        case 2: return "Central body has not been defined";
+        case 3: return "Final time or time step have not been set";
+    }
+    return "Unknown exit code";
+}
+
+void MultistepPropagator::addRestartTime(double t)
+{
+    restartTimes.insert(std::upper_bound(restartTimes.begin(), restartTimes.end(), t), t);
+}
+
+void MultistepPropagator::clearRestartTimes()
+{
+    restartTimes.clear();
+}
+
+const std::vector<double>& MultistepPropagator::getRestartTimes() const
+{
+    return restartTimes;
+}
+
+/* AdamsBashforthMoultonPropagator */
+
+std::unique_ptr<Propagator> AdamsBashforthMoultonPropagator::clone() const
+{
+    return std::unique_ptr<Propagator>(new AdamsBashforthMoultonPropagator(*this));
+}
+
+void AdamsBashforthMoultonPropagator::start(const std::array<EphemerisEntry, POINTS>& states,
+                                            const std::array<Vec3, POINTS>& accelerations, double h)
+{
+    this->h = h;
+    y = states[POINTS - 1].getState();
+
+    differences.fill(State6{});
+    for (unsigned int i = 0; i < POINTS; i++)
+    {
+        const Vec3 v = states[i].getVelocity(), &a = accelerations[i];
+        advanceDifferences(differences, State6{v[0], v[1], v[2], a[0], a[1], a[2]});
+    }
+}
+
+EphemerisEntry AdamsBashforthMoultonPropagator::step(const GravityModel& gravity, double t)
+{
+    // Predict with Adams-Bashforth
+    State6 increment;
+    for (unsigned int j = 0; j < POINTS; j++)
+        increment += coefficients.adamsBashforth[j]*differences[j];
+    State6 predicted = y + h*increment;
+
+    // Correcting with Adams-Moulton only adds the newest difference
+    std::array<State6, POINTS> newDifferences = differences;
+    advanceDifferences(newDifferences, derivative(gravity, t, predicted));
+    State6 newest = newDifferences[POINTS - 1] - differences[POINTS - 1];
+    y = predicted + (h*coefficients.adamsBashforth[POINTS])*newest;
+
+    advanceDifferences(differences, derivative(gravity, t, y));
+
+    return {y[0], y[1], y[2], y[3], y[4], y[5], t};
+}
+
+/* GaussJacksonPropagator */
+
+std::unique_ptr<Propagator> GaussJacksonPropagator::clone() const
+{
+    return std::unique_ptr<Propagator>(new GaussJacksonPropagator(*this));
+}
+
+void GaussJacksonPropagator::start(const std::array<EphemerisEntry, POINTS>& states,
+                                   const std::array<Vec3, POINTS>& accelerations, double h)
+{
+    this->h = h;
+
+    differences.fill(Vec3{});
+    for (const Vec3& a : accelerations)
+        advanceDifferences(differences, a);
+
+    // Integration constants: the sums that make the corrector formulas
+    // give the position and velocity of the last state
+    const EphemerisEntry& last = states[POINTS - 1];
+    firstSum = last.getVelocity()/h;
+    for (unsigned int j = 1; j <= POINTS; j++)
+        firstSum -= coefficients.adamsMoulton[j]*differences[j - 1];
+
+    secondSum = last.getPosition()/(h*h) + firstSum;
+    for (unsigned int j = 2; j <= POINTS + 1; j++)
+        secondSum -= coefficients.cowell[j]*differences[j - 2];
+}
+
+EphemerisEntry GaussJacksonPropagator::step(const GravityModel& gravity, double t)
+{
+    // Predict position with Stormer, evaluate and correct with Cowell
+    Vec3 sum = secondSum;
+    for (unsigned int j = 2; j <= POINTS + 1; j++)
+        sum += coefficients.stormer[j]*differences[j - 2];
+    Vec3 predicted = (h*h)*sum;
+
+    std::array<Vec3, POINTS> newDifferences = differences;
+    advanceDifferences(newDifferences, gravity.getAcceleration(t, predicted));
+
+    sum = secondSum;
+    for (unsigned int j = 2; j <= POINTS + 1; j++)
+        sum += coefficients.cowell[j]*newDifferences[j - 2];
+    Vec3 x = (h*h)*sum;
+
+    // Evaluate again, update sums and differences and obtain the velocity
+    advanceDifferences(differences, gravity.getAcceleration(t, x));
+    firstSum += differences[0];
+    secondSum += firstSum;
+
+    sum = firstSum;
+    for (unsigned int j = 1; j <= POINTS; j++)
+        sum += coefficients.adamsMoulton[j]*differences[j - 1];
+
+    return {x, h*sum, t};
+}
@@ -0,0 +1,48 @@
+#include "PropagationStats.hpp"
+
+namespace
+{
+    /// @return @param count per second of @param seconds, 0 if no time was measured
+    double rate(double count, double seconds)
+    {
+        return seconds > 0 ? count/seconds : 0;
+    }
+}
+
+std::ostream& PropagationStats::output(std::ostream& os) const
+{
+    os << "propagations: " << runs << std::endl;
+    os << "exit code: " << exitCode << std::endl;
+    os << "steps: " << count.steps << std::endl;
+    os << "rejected steps: " << count.rejectedSteps << std::endl;
+    os << "force evaluations: " << count.forceEvaluations << std::endl;
+    os << "check time: " << checkSeconds << " s" << std::endl;
+    os << "force model setup time: " << count.modelSeconds << " s" << std::endl;
+    os << "integration time: " << propagatorSeconds - count.modelSeconds << " s" << std::endl;
+    os << "total time: " << totalSeconds << " s" << std::endl;
+    os << "steps per second: " << rate(count.steps, totalSeconds) << std::endl;
+    os << "ephemeris entries: " << entries << std::endl;
+    os << "ephemeris chunks: " << chunks << std::endl;
+    os << "ephemeris memory: " << ephemerisBytes << " bytes" << std::endl;
+    os << "chunk pool memory: " << poolBytes << " bytes";
+    return os;
+}
+
+std::ostream& PropagationStats::writeJson(std::ostream& os) const
+{
+    os << "{\"runs\": " << runs
+       << ", \"exit_code\": " << exitCode
+       << ", \"steps\": " << count.steps
+       << ", \"rejected_steps\": " << count.rejectedSteps
+       << ", \"force_evaluations\": " << count.forceEvaluations
+       << ", \"check_seconds\": " << checkSeconds
+       << ", \"model_seconds\": " << count.modelSeconds
+       << ", \"integration_seconds\": " << propagatorSeconds - count.modelSeconds
+       << ", \"total_seconds\": " << totalSeconds
+       << ", \"steps_per_second\": " << rate(count.steps, totalSeconds)
+       << ", \"entries\": " << entries
+       << ", \"chunks\": " << chunks
+       << ", \"ephemeris_bytes\": " << ephemerisBytes
+       << ", \"pool_bytes\": " << poolBytes << "}";
+    return os;
+}
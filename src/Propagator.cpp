@@ -1,6 +1,6 @@
 #include "Propagator.hpp"
 #include "Enviroment.hpp"
-#include "MVector.hpp"
+#include "FixedVector.hpp"
 #include <cmath>
 #include <iostream>
 
@@ -14,25 +14,43 @@ std::string Propagator::getExitMessage(int i)
     }
 }
 
-int LeapfrogPropagator::propagate(Enviroment& env)
+int Propagator::propagate(Enviroment& env)
+{
+    MemorySink sink{env.getEphemeris()};
+    return propagate(env, sink);
+}
+
+unsigned int Propagator::countSteps(double t0, double tf, double dt)
+{
+    // Accumulate as the propagators do, so rounding gives the same count
+    unsigned int steps{0};
+    for (double t = t0; t < tf - dt; t += dt)
+        steps++;
+    return steps;
+}
+
+int LeapfrogPropagator::propagate(Enviroment& env, EphemerisSink& sink)
 {
     if (env.getCentralBody().getGravitationalParameter() == 0) return 2;
 
-    Ephemeris& eph = env.getEphemeris();
+    const Ephemeris& eph = env.getEphemeris();
 
     if (eph.empty()) return 1;
     
-    eph.reset();
-
-    double t{eph.at(0).getTime()}, tf{env.getFinalTime()}, dt{env.getTimeStep()};
+    EphemerisEntry initial = eph.at(0);
+    double t{initial.getTime()}, tf{env.getFinalTime()}, dt{env.getTimeStep()};
 
     if (t >= tf - dt) return 3;
 
+    sink.begin(initial, countSteps(t, tf, dt) + 1);
+
     int i = 0;
 
-    MVector xi = {eph.at(0).getX(), eph.at(0).getY(), eph.at(0).getZ()};
-    MVector vi = {eph.at(0).getVx(), eph.at(0).getVy(), eph.at(0).getVz()};
-    MVector ai = env.getAcceleration(eph.at(0));
+    Vec3 xi = initial.getPosition();
+    Vec3 vi = initial.getVelocity();
+    const GravityModel gravity = env.getGravityModel();
+    Vec3 ai = gravity.getAcceleration(t, xi);
+    double dt2 = pow(dt,2);
 
     while (t < tf - dt)
     {
@@ -43,14 +61,16 @@ int LeapfrogPropagator::propagate(Enviroment& env)
         std::cout << "  " << ai << std::endl;
         */
         t += dt;
-        xi = xi + vi*dt + ai*pow(dt,2)/2;
-        MVector aiplus1 = env.getAcceleration({xi[0], xi[1], xi[2], 0,0,0,t});
+        xi = xi + vi*dt + ai*dt2/2;
+        Vec3 aiplus1 = gravity.getAcceleration(t, xi);
         vi = vi + (ai + aiplus1)*dt/2;
-        ai = std::move(aiplus1);
-        eph.include({xi[0], xi[1], xi[2], vi[0], vi[1], vi[2],t});
+        ai = aiplus1;
+        StatsCounters::countStep();
+        sink.append({xi, vi, t});
         i++;
     }
 
+    sink.end();
     return 0;
 }
 
@@ -63,4 +83,32 @@ std::string LeapfrogPropagator::getExitMessage(int i)
         case 2: return "Central body has not been defined";
         case 3: return "Final time or time step have not been set";
     }
+}
+
+std::unique_ptr<Propagator> LeapfrogPropagator::clone() const
+{
+    return std::unique_ptr<Propagator>(new LeapfrogPropagator(*this));
+}
+
+EphemerisEntry interpolateQuintic(const EphemerisEntry& s0, const Vec3& a0, 
+                                  const EphemerisEntry& s1, const Vec3& a1, double t)
+{
+    double h = s1.getTime() - s0.getTime();
+    double s = (t - s0.getTime()) / h, s2 = s*s, s3 = s2*s, s4 = s3*s, s5 = s4*s;
+
+    // Quintic Hermite basis functions and their derivatives with respect to s
+    double h0 = 1 - 10*s3 + 15*s4 - 6*s5, d0 = -30*s2 + 60*s3 - 30*s4;
+    double h1 = s - 6*s3 + 8*s4 - 3*s5, d1 = 1 - 18*s2 + 32*s3 - 15*s4;
+    double h2 = 0.5*s2 - 1.5*s3 + 1.5*s4 - 0.5*s5, d2 = s - 4.5*s2 + 6*s3 - 2.5*s4;
+    double h3 = 0.5*s3 - s4 + 0.5*s5, d3 = 1.5*s2 - 4*s3 + 2.5*s4;
+    double h4 = -4*s3 + 7*s4 - 3*s5, d4 = -12*s2 + 28*s3 - 15*s4;
+    double h5 = 10*s3 - 15*s4 + 6*s5, d5 = 30*s2 - 60*s3 + 30*s4;
+
+    Vec3 p0 = s0.getPosition(), v0 = s0.getVelocity();
+    Vec3 p1 = s1.getPosition(), v1 = s1.getVelocity();
+
+    Vec3 r = h0*p0 + (h1*h)*v0 + (h2*h*h)*a0 + (h3*h*h)*a1 + (h4*h)*v1 + h5*p1;
+    Vec3 v = (d0/h)*p0 + d1*v0 + (d2*h)*a0 + (d3*h)*a1 + d4*v1 + (d5/h)*p1;
+
+    return {r, v, t};
 }
\ No newline at end of file
@@ -0,0 +1,224 @@
+#include "RungeKuttaPropagator.hpp"
+#include "Enviroment.hpp"
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+namespace
+{
+    const ButcherTableau dormandPrince
+    {
+        7,
+        {0, 1.0/5, 3.0/10, 4.0/5, 8.0/9, 1, 1},
+        {
+            {},
+            {1.0/5},
+            {3.0/40, 9.0/40},
+            {44.0/45, -56.0/15, 32.0/9},
+            {19372.0/6561, -25360.0/2187, 64448.0/6561, -212.0/729},
+            {9017.0/3168, -355.0/33, 46732.0/5247, 49.0/176, -5103.0/18656},
+            {35.0/384, 0, 500.0/1113, 125.0/192, -2187.0/6784, 11.0/84}
+        },
+        {35.0/384, 0, 500.0/1113, 125.0/192, -2187.0/6784, 11.0/84, 0},
+        {35.0/384 - 5179.0/57600, 0, 500.0/1113 - 7571.0/16695, 125.0/192 - 393.0/640,
+         -2187.0/6784 + 92097.0/339200, 11.0/84 - 187.0/2100, -1.0/40},
+        4,
+        true
+    };
+
+    const ButcherTableau fehlberg78
+    {
+        13,
+        {0, 2.0/27, 1.0/9, 1.0/6, 5.0/12, 1.0/2, 5.0/6, 1.0/6, 2.0/3, 1.0/3, 1, 0, 1},
+        {
+            {},
+            {2.0/27},
+            {1.0/36, 1.0/12},
+            {1.0/24, 0, 1.0/8},
+            {5.0/12, 0, -25.0/16, 25.0/16},
+            {1.0/20, 0, 0, 1.0/4, 1.0/5},
+            {-25.0/108, 0, 0, 125.0/108, -65.0/27, 125.0/54},
+            {31.0/300, 0, 0, 0, 61.0/225, -2.0/9, 13.0/900},
+            {2, 0, 0, -53.0/6, 704.0/45, -107.0/9, 67.0/90, 3},
+            {-91.0/108, 0, 0, 23.0/108, -976.0/135, 311.0/54, -19.0/60, 17.0/6, -1.0/12},
+            {2383.0/4100, 0, 0, -341.0/164, 4496.0/1025, -301.0/82, 2133.0/4100, 45.0/82, 45.0/164, 18.0/41},
+            {3.0/205, 0, 0, 0, 0, -6.0/41, -3.0/205, -3.0/41, 3.0/41, 6.0/41, 0},
+            {-1777.0/4100, 0, 0, -341.0/164, 4496.0/1025, -289.0/82, 2193.0/4100, 51.0/82, 33.0/164, 12.0/41, 0, 1}
+        },
+        {0, 0, 0, 0, 0, 34.0/105, 9.0/35, 9.0/35, 9.0/280, 9.0/280, 0, 41.0/840, 41.0/840},
+        {-41.0/840, 0, 0, 0, 0, 0, 0, 0, 0, 0, -41.0/840, 41.0/840, 41.0/840},
+        7,
+        false
+    };
+
+    /// @return derivative of state @param y at time @param t: velocity and acceleration
+    State6 derivative(const GravityModel& gravity, double t, const State6& y)
+    {
+        Vec3 a = gravity.getAcceleration(t, Vec3{y[0], y[1], y[2]});
+        return {y[3], y[4], y[5], a[0], a[1], a[2]};
+    }
+
+    Vec3 acceleration(const State6& f)
+    {
+        return {f[3], f[4], f[5]};
+    }
+
+    EphemerisEntry toEntry(const State6& y, double t)
+    {
+        return {y[0], y[1], y[2], y[3], y[4], y[5], t};
+    }
+}
+
+int AdaptiveRungeKuttaPropagator::propagate(Enviroment& env, EphemerisSink& sink)
+{
+    if (env.getCentralBody().getGravitationalParameter() == 0) return 2;
+
+    const Ephemeris& eph = env.getEphemeris();
+
+    if (eph.empty()) return 1;
+    
+    EphemerisEntry initial = eph.at(0);
+    double t{initial.getTime()}, tf{env.getFinalTime()}, dt{env.getTimeStep()};
+
+    if (t >= tf - dt) return 3;
+
+    sink.begin(initial, countSteps(t, tf, dt) + 1);
+
+    const GravityModel gravity = env.getGravityModel();
+    State6 y = initial.getState();
+    State6 f = derivative(gravity, t, y);
+    double h = initialStep(gravity, t, y, f);
+
+    std::vector<State6> k(tableau.stages);
+
+    // Output times follow the same sequence as LeapfrogPropagator
+    double last{t}, next{t + dt};
+
+    while (last < tf - dt)
+    {
+        k[0] = f;
+        for (unsigned int i = 1; i < tableau.stages; i++)
+        {
+            State6 sum;
+            for (unsigned int j = 0; j < i; j++)
+                if (tableau.a[i][j] != 0) sum += tableau.a[i][j]*k[j];
+
+            k[i] = derivative(gravity, t + tableau.c[i]*h, y + h*sum);
+        }
+
+        State6 increment, error;
+        for (unsigned int i = 0; i < tableau.stages; i++)
+        {
+            if (tableau.b[i] != 0) increment += tableau.b[i]*k[i];
+            if (tableau.e[i] != 0) error += tableau.e[i]*k[i];
+        }
+
+        State6 yNew = y + h*increment;
+        double err = errorNorm(h*error, y, yNew);
+
+        if (err <= 1)
+        {
+            State6 fNew = tableau.fsal ? k[tableau.stages - 1] : derivative(gravity, t + h, yNew);
+
+            EphemerisEntry s0 = toEntry(y, t), s1 = toEntry(yNew, t + h);
+            while (last < tf - dt && next <= t + h)
+            {
+                sink.append(interpolateQuintic(s0, acceleration(f), s1, acceleration(fNew), next));
+                last = next;
+                next = last + dt;
+            }
+
+            t += h;
+            y = yNew;
+            f = fNew;
+            StatsCounters::countStep();
+        }
+        else StatsCounters::countRejectedStep();
+
+        double factor = err == 0 ? 5 : 0.9*std::pow(err, -1.0/(tableau.errorOrder + 1));
+        factor = std::min(err <= 1 ? 5.0 : 1.0, std::max(0.2, factor));
+        h *= factor;
+
+        if (t + h == t)
+        {
+            sink.end();
+            return 4;
+        }
+    }
+
+    sink.end();
+    return 0;
+}
+
+double AdaptiveRungeKuttaPropagator::initialStep(const GravityModel& gravity, double t, const State6& y, const State6& f) const
+{
+    // Hairer, Norsett and Wanner, Solving Ordinary Differential Equations I, II.4
+    double d0 = errorNorm(y, y, y), d1 = errorNorm(f, y, y);
+    double h0 = (d0 < 1e-5 || d1 < 1e-5) ? 1e-6 : 0.01*d0/d1;
+
+    State6 f1 = derivative(gravity, t + h0, y + h0*f);
+    double d2 = errorNorm(f1 - f, y, y) / h0;
+
+    double dMax = std::max(d1, d2);
+    double h1 = dMax <= 1e-15 ? std::max(1e-6, h0*1e-3) 
+                              : std::pow(0.01/dMax, 1.0/(tableau.errorOrder + 2));
+
+    return std::min(100*h0, h1);
+}
+
+double AdaptiveRungeKuttaPropagator::errorNorm(const State6& v, const State6& y0, const State6& y1) const
+{
+    double sum{0};
+    for (std::size_t i = 0; i < State6::size(); i++)
+    {
+        double scale = absoluteTolerance + relativeTolerance*std::max(std::abs(y0[i]), std::abs(y1[i]));
+        sum += (v[i]/scale)*(v[i]/scale);
+    }
+    return std::sqrt(sum / State6::size());
+}
+
+std::string AdaptiveRungeKuttaPropagator::getExitMessage(int i)
+{
+    switch(i)
+    {
+        case 0: return "Propagation succesful";
+        case 1: return "No initial position has been set";
+        case 2: return "Central body has not been defined";
+        case 3: return "Final time or time step have not been set";
+        case 4: return "Step size became too small for the tolerances";
+    }
+    return "Unknown exit code";
+}
+
+void AdaptiveRungeKuttaPropagator::setTolerances(double absolute, double relative)
+{
+    if (absolute <= 0 || relative <= 0)
+        throw std::invalid_argument("Tolerances must be higher than 0");
+
+    absoluteTolerance = absolute;
+    relativeTolerance = relative;
+}
+
+double AdaptiveRungeKuttaPropagator::getAbsoluteTolerance() const
+{
+    return absoluteTolerance;
+}
+
+double AdaptiveRungeKuttaPropagator::getRelativeTolerance() const
+{
+    return relativeTolerance;
+}
+
+DormandPrincePropagator::DormandPrincePropagator() : AdaptiveRungeKuttaPropagator(dormandPrince) {};
+
+std::unique_ptr<Propagator> DormandPrincePropagator::clone() const
+{
+    return std::unique_ptr<Propagator>(new DormandPrincePropagator(*this));
+}
+
+RungeKuttaFehlberg78Propagator::RungeKuttaFehlberg78Propagator() : AdaptiveRungeKuttaPropagator(fehlberg78) {};
+
+std::unique_ptr<Propagator> RungeKuttaFehlberg78Propagator::clone() const
+{
+    return std::unique_ptr<Propagator>(new RungeKuttaFehlberg78Propagator(*this));
+}
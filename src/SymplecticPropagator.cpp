@@ -0,0 +1,112 @@
+#include "SymplecticPropagator.hpp"
+#include "Enviroment.hpp"
+#include <cmath>
+
+namespace
+{
+    /** @return weights of the symmetric composition w_m ... w_1 w_0 w_1 ... w_m
+     *  from the outer ones @param outer = {w_1, ..., w_m}; w_0 makes them add up to 1
+     */
+    std::vector<double> symmetricComposition(const std::vector<double>& outer)
+    {
+        double sum{0};
+        for (double w : outer) sum += w;
+
+        std::vector<double> weights(outer.rbegin(), outer.rend());
+        weights.push_back(1 - 2*sum);
+        weights.insert(weights.end(), outer.begin(), outer.end());
+        return weights;
+    }
+
+    const double cubeRoot2 = std::cbrt(2.0);
+
+    const std::vector<double> yoshida4 = symmetricComposition({1/(2 - cubeRoot2)});
+
+    const std::vector<double> yoshida6 = symmetricComposition(
+        {-1.17767998417887, 0.235573213359357, 0.784513610477560});
+
+    const std::vector<double> yoshida8 = symmetricComposition(
+        {0.102799849391985, -1.96061023297549, 1.93813913762276, -0.158240635368243,
+         -1.44485223686048, 0.253693336566229, 0.914844246229740});
+}
+
+int SymplecticPropagator::propagate(Enviroment& env, EphemerisSink& sink)
+{
+    if (env.getCentralBody().getGravitationalParameter() == 0) return 2;
+
+    const Ephemeris& eph = env.getEphemeris();
+
+    if (eph.empty()) return 1;
+
+    EphemerisEntry initial = eph.at(0);
+    double t{initial.getTime()}, tf{env.getFinalTime()}, dt{env.getTimeStep()};
+
+    if (t >= tf - dt) return 3;
+
+    sink.begin(initial, countSteps(t, tf, dt) + 1);
+
+    // Substep lengths and the times they end at do not change between steps
+    std::vector<double> h, halfH2, ends;
+    for (double w : weights)
+    {
+        h.push_back(w*dt);
+        halfH2.push_back(w*dt*w*dt/2);
+        ends.push_back((ends.empty() ? 0 : ends.back()) + w*dt);
+    }
+
+    Vec3 x = initial.getPosition();
+    Vec3 v = initial.getVelocity();
+    const GravityModel gravity = env.getGravityModel();
+    Vec3 a = gravity.getAcceleration(t, x);
+
+    while (t < tf - dt)
+    {
+        const double start = t;
+        t += dt;
+        for (unsigned int i = 0; i < h.size(); i++)
+        {
+            x = x + v*h[i] + a*halfH2[i];
+            Vec3 aNext = gravity.getAcceleration(i + 1 < h.size() ? start + ends[i] : t, x);
+            v = v + (a + aNext)*(h[i]/2);
+            a = aNext;
+        }
+        StatsCounters::countStep();
+        sink.append({x, v, t});
+    }
+
+    sink.end();
+    return 0;
+}
+
+std::string SymplecticPropagator::getExitMessage(int i)
+{
+    switch(i)
+    {
+        case 0: return "Propagation succesful";
+        case 1: return "No initial position has been set";
+        case 2: return "Central body has not been defined";
+        case 3: return "Final time or time step have not been set";
+    }
+    return "Unknown exit code";
+}
+
+Yoshida4Propagator::Yoshida4Propagator() : SymplecticPropagator(yoshida4) {};
+
+std::unique_ptr<Propagator> Yoshida4Propagator::clone() const
+{
+    return std::unique_ptr<Propagator>(new Yoshida4Propagator(*this));
+}
+
+Yoshida6Propagator::Yoshida6Propagator() : SymplecticPropagator(yoshida6) {};
+
+std::unique_ptr<Propagator> Yoshida6Propagator::clone() const
+{
+    return std::unique_ptr<Propagator>(new Yoshida6Propagator(*this));
+}
+
+Yoshida8Propagator::Yoshida8Propagator() : SymplecticPropagator(yoshida8) {};
+
+std::unique_ptr<Propagator> Yoshida8Propagator::clone() const
+{
+    return std::unique_ptr<Propagator>(new Yoshida8Propagator(*this));
+}
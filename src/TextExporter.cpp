@@ -0,0 +1,232 @@
+#include "TextExporter.hpp"
+#include <algorithm>
+#include <charconv>
+#include <condition_variable>
+#include <mutex>
+#include <sstream>
+#include <stdexcept>
+#include <thread>
+
+namespace
+{
+    const char* const COLUMN_NAMES[EphemerisChunk::COLUMNS] = {"t", "x", "y", "z", "vx", "vy", "vz"};
+}
+
+TextExporter::TextExporter(std::ostream& os, TextExportFormat format) : 
+    os(os), format(std::move(format)), rowSize(maxRowSize(this->format)),
+    buffer(std::max(BUFFER_SIZE, EphemerisChunk::CAPACITY*rowSize))
+{
+    if (this->format.header)
+    {
+        std::string line = header(this->format);
+        os.write(line.data(), line.size());
+    }
+}
+
+TextExporter::~TextExporter()
+{
+    flush();
+}
+
+void TextExporter::write(const EphemerisEntry& entry)
+{
+    const double values[EphemerisChunk::COLUMNS] = {entry.getTime(), entry.getX(), entry.getY(), entry.getZ(),
+                                                    entry.getVx(), entry.getVy(), entry.getVz()};
+    if (buffer.size() - used < rowSize)
+        flush();
+    used = formatRow(format, values, buffer.data() + used) - buffer.data();
+}
+
+void TextExporter::write(const Ephemeris& ephemeris)
+{
+    const unsigned int CHUNK = EphemerisChunk::CAPACITY;
+    unsigned int chunks = (ephemeris.size() + CHUNK - 1) / CHUNK;
+    unsigned int threads = format.threads > 0 ? format.threads : std::max(1u, std::thread::hardware_concurrency());
+
+    if (threads > 1 && chunks > 1)
+    {
+        flush();
+        writeParallel(ephemeris, std::min(threads, chunks));
+        return;
+    }
+
+    for (unsigned int k = 0; k < chunks; k++)
+    {
+        if (buffer.size() - used < CHUNK*rowSize)
+            flush();
+        used += formatChunk(ephemeris, k, buffer.data() + used);
+    }
+}
+
+std::size_t TextExporter::formatChunk(const Ephemeris& ephemeris, unsigned int k, char* out) const
+{
+    char* end = out;
+    double values[EphemerisChunk::COLUMNS];
+
+    if (ephemeris.isAnalytic()) // Entries are not stored: generate them
+    {
+        unsigned int first = k*EphemerisChunk::CAPACITY;
+        unsigned int last = std::min(first + EphemerisChunk::CAPACITY, ephemeris.size());
+        for (unsigned int i = first; i < last; i++)
+        {
+            EphemerisEntry entry = ephemeris.at(i);
+            const double entryValues[EphemerisChunk::COLUMNS] = {entry.getTime(), entry.getX(), entry.getY(), 
+                entry.getZ(), entry.getVx(), entry.getVy(), entry.getVz()};
+            end = formatRow(format, entryValues, end);
+        }
+        return end - out;
+    }
+
+    // Read the columns of the chunk directly, without building entries
+    Span<const double> columns[EphemerisChunk::COLUMNS];
+    for (unsigned int c = 0; c < EphemerisChunk::COLUMNS; c++)
+        columns[c] = ephemeris.column(static_cast<EphemerisColumn>(c), k);
+
+    for (std::size_t i = 0; i < columns[0].size(); i++)
+    {
+        for (unsigned int c = 0; c < EphemerisChunk::COLUMNS; c++)
+            values[c] = columns[c][i];
+        end = formatRow(format, values, end);
+    }
+    return end - out;
+}
+
+void TextExporter::writeParallel(const Ephemeris& ephemeris, unsigned int threads)
+{
+    const unsigned int chunks = (ephemeris.size() + EphemerisChunk::CAPACITY - 1) / EphemerisChunk::CAPACITY;
+    const unsigned int slots = threads*CHUNKS_IN_FLIGHT;
+
+    // Chunk k is formatted into slot k % slots. A thread only takes a chunk
+    // once the chunk that used its slot before has been written, which
+    // bounds the memory used however slow the stream is.
+    struct Slot
+    {
+        std::vector<char> text;
+        std::size_t length{0};
+        bool ready{false};
+    };
+    std::vector<Slot> slot(slots);
+
+    std::mutex mutex;
+    std::condition_variable formatted, written;
+    unsigned int nextChunk{0}, writtenChunks{0};
+
+    auto work = [&]()
+    {
+        std::vector<char> text(EphemerisChunk::CAPACITY*rowSize);
+        while (true)
+        {
+            unsigned int k;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                written.wait(lock, [&]() { return nextChunk >= chunks || nextChunk < writtenChunks + slots; });
+                if (nextChunk >= chunks) return;
+                k = nextChunk++;
+            }
+
+            std::size_t length = formatChunk(ephemeris, k, text.data());
+
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                // Hand the text over and keep the buffer the slot had
+                Slot& s = slot[k % slots];
+                std::swap(s.text, text);
+                text.resize(EphemerisChunk::CAPACITY*rowSize);
+                s.length = length;
+                s.ready = true;
+            }
+            formatted.notify_one();
+        }
+    };
+
+    std::vector<std::thread> workers;
+    for (unsigned int i = 0; i < threads; i++)
+        workers.emplace_back(work);
+
+    // Single writer: this thread, in order
+    for (unsigned int k = 0; k < chunks; k++)
+    {
+        Slot& s = slot[k % slots];
+        std::vector<char> text;
+        std::size_t length;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            formatted.wait(lock, [&]() { return s.ready; });
+            std::swap(text, s.text);
+            length = s.length;
+            s.ready = false;
+        }
+
+        os.write(text.data(), length);
+
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            s.text = std::move(text);
+            writtenChunks = k + 1;
+        }
+        written.notify_all();
+    }
+
+    for (std::thread& worker : workers)
+        worker.join();
+}
+
+void TextExporter::flush()
+{
+    os.write(buffer.data(), used);
+    used = 0;
+}
+
+char* TextExporter::formatRow(const TextExportFormat& format, const double* values, char* out)
+{
+    for (std::size_t c = 0; c < format.columns.size(); c++)
+    {
+        if (c > 0) *out++ = format.separator;
+        // maxRowSize leaves room for the longest double, the conversion cannot fail
+        double value = values[static_cast<unsigned int>(format.columns[c])];
+        out = format.precision > 0 
+            ? std::to_chars(out, out + 24, value, std::chars_format::general, std::min(format.precision, 17)).ptr
+            : std::to_chars(out, out + 24, value).ptr;
+    }
+    *out++ = '\n';
+    return out;
+}
+
+std::size_t TextExporter::maxRowSize(const TextExportFormat& format)
+{
+    return std::max<std::size_t>(1, format.columns.size()*25);
+}
+
+std::string TextExporter::header(const TextExportFormat& format)
+{
+    std::string line;
+    for (std::size_t c = 0; c < format.columns.size(); c++)
+    {
+        if (c > 0) line += format.separator;
+        line += COLUMN_NAMES[static_cast<unsigned int>(format.columns[c])];
+    }
+    return line + '\n';
+}
+
+std::vector<EphemerisColumn> TextExporter::parseColumns(const std::string& names)
+{
+    std::string list = names;
+    for (char& ch : list)
+        if (ch == ',') ch = ' ';
+
+    std::vector<EphemerisColumn> columns;
+    std::istringstream stream(list);
+    std::string name;
+    while (stream >> name)
+    {
+        unsigned int c = 0;
+        while (c < EphemerisChunk::COLUMNS && name != COLUMN_NAMES[c]) c++;
+        if (c == EphemerisChunk::COLUMNS)
+            throw std::invalid_argument("Unknown column " + name + ", columns are t, x, y, z, vx, vy and vz");
+        columns.push_back(static_cast<EphemerisColumn>(c));
+    }
+
+    if (columns.empty())
+        throw std::invalid_argument("At least one column must be given");
+    return columns;
+}
@@ -0,0 +1,353 @@
+#include "ThirdBody.hpp"
+#include "Chebyshev.hpp"
+#include <cmath>
+#include <iomanip>
+#include <limits>
+#include <sstream>
+#include <stdexcept>
+
+namespace
+{
+    constexpr double DEGREE = M_PI/180;
+    constexpr double ARCSECOND = DEGREE/3600;
+    /// Obliquity of the ecliptic at J2000
+    constexpr double OBLIQUITY = 23.43929111*DEGREE;
+    constexpr double SECONDS_PER_CENTURY = 36525*86400.0;
+
+    /// Segment lengths and coefficients per coordinate of the tables of the series
+    constexpr double SUN_SPAN = 16*86400.0, MOON_SPAN = 4*86400.0;
+    constexpr unsigned int SUN_COEFFICIENTS = 10, MOON_COEFFICIENTS = 11;
+
+    /// @return equatorial position of ecliptic longitude @param lon, latitude @param lat and distance @param r
+    Vec3 fromEcliptic(double lon, double lat, double r)
+    {
+        const double x = r*std::cos(lat)*std::cos(lon), y = r*std::cos(lat)*std::sin(lon), z = r*std::sin(lat);
+        return {x, y*std::cos(OBLIQUITY) - z*std::sin(OBLIQUITY), y*std::sin(OBLIQUITY) + z*std::cos(OBLIQUITY)};
+    }
+
+    /// @return the next line of @param is that is not empty nor a comment, false if there is none
+    bool nextLine(std::istream& is, std::string& line, unsigned int& lineNumber)
+    {
+        while (std::getline(is, line))
+        {
+            lineNumber++;
+            std::size_t first = line.find_first_not_of(" \t\r");
+            if (first != std::string::npos && line[first] != '#') return true;
+        }
+        return false;
+    }
+
+    std::invalid_argument lineError(unsigned int lineNumber, const std::string& expected)
+    {
+        return std::invalid_argument("Line " + std::to_string(lineNumber) + " must be: " + expected);
+    }
+}
+
+/* ChebyshevTable */
+
+ChebyshevTable::ChebyshevTable(double start, double span, unsigned int segments, unsigned int coefficients) :
+    start(start), span(span), segments(segments), count(coefficients)
+{
+    if (!(span > 0) || segments == 0 || coefficients == 0)
+        throw std::invalid_argument("A Chebyshev table needs a positive span, segments and coefficients");
+
+    data.assign(std::size_t(segments)*3*count, 0);
+}
+
+ChebyshevTable ChebyshevTable::fit(const std::function<Vec3(double)>& position, double start, double end,
+                                   double span, unsigned int coefficients)
+{
+    if (!(end > start))
+        throw std::invalid_argument("The end of a Chebyshev table must be after its start");
+
+    ChebyshevTable table{start, span, static_cast<unsigned int>(std::ceil((end - start)/span)), coefficients};
+
+    std::vector<double> values(3*coefficients);
+    for (unsigned int s = 0; s < table.segments; s++)
+    {
+        const double middle = start + (s + 0.5)*span;
+        for (unsigned int j = 0; j < coefficients; j++)
+        {
+            Vec3 p = position(middle + chebyshevNode(j, coefficients)*span/2);
+            for (unsigned int c = 0; c < 3; c++)
+                values[c*coefficients + j] = p[c];
+        }
+
+        double* segment = table.coefficients(s);
+        for (unsigned int c = 0; c < 3; c++)
+            chebyshevFit(values.data() + c*coefficients, coefficients, segment + c*coefficients);
+    }
+
+    return table;
+}
+
+double ChebyshevTable::getStart() const
+{
+    return start;
+}
+
+double ChebyshevTable::getEnd() const
+{
+    return start + segments*span;
+}
+
+double ChebyshevTable::getSpan() const
+{
+    return span;
+}
+
+unsigned int ChebyshevTable::getSegments() const
+{
+    return segments;
+}
+
+unsigned int ChebyshevTable::getCoefficients() const
+{
+    return count;
+}
+
+bool ChebyshevTable::covers(double t0, double t1) const
+{
+    return t0 >= getStart() && t1 <= getEnd();
+}
+
+unsigned int ChebyshevTable::segment(double t) const
+{
+    double s = std::floor((t - start)/span);
+    if (!(s > 0)) return 0;
+    if (s >= segments) return segments - 1;
+    return static_cast<unsigned int>(s);
+}
+
+double* ChebyshevTable::coefficients(unsigned int segment)
+{
+    if (segment >= segments)
+        throw std::out_of_range("The Chebyshev table has no segment " + std::to_string(segment));
+
+    return data.data() + std::size_t(segment)*3*count;
+}
+
+const double* ChebyshevTable::coefficients(unsigned int segment) const
+{
+    return const_cast<ChebyshevTable*>(this)->coefficients(segment);
+}
+
+Vec3 ChebyshevTable::at(double t) const
+{
+    if (!covers(t, t))
+        throw std::out_of_range("Time outside of the Chebyshev table");
+
+    unsigned int s = segment(t);
+    const double* c = coefficients(s);
+    const double x = 2*(t - start - s*span)/span - 1;
+    return {chebyshev(c, count, x), chebyshev(c + count, count, x), chebyshev(c + 2*count, count, x)};
+}
+
+/* ThirdBody */
+
+ThirdBody ThirdBody::sun(double start, double end)
+{
+    auto table = std::make_shared<const ChebyshevTable>(
+        ChebyshevTable::fit(sunPosition, start, end, SUN_SPAN, SUN_COEFFICIENTS));
+    return {"sun", 132712440018, table};
+}
+
+ThirdBody ThirdBody::moon(double start, double end)
+{
+    auto table = std::make_shared<const ChebyshevTable>(
+        ChebyshevTable::fit(moonPosition, start, end, MOON_SPAN, MOON_COEFFICIENTS));
+    return {"moon", 4902.800066, table};
+}
+
+Vec3 sunPosition(double t)
+{
+    const double T = t/SECONDS_PER_CENTURY;
+    const double M = (357.5256 + 35999.049*T)*DEGREE;
+
+    const double lon = 282.94*DEGREE + M + 6892*ARCSECOND*std::sin(M) + 72*ARCSECOND*std::sin(2*M);
+    const double r = (149.619 - 2.499*std::cos(M) - 0.021*std::cos(2*M))*1e6;
+    return fromEcliptic(lon, 0, r);
+}
+
+Vec3 moonPosition(double t)
+{
+    const double T = t/SECONDS_PER_CENTURY;
+
+    // Mean longitude referred to the equinox of J2000 and fundamental arguments
+    const double L0 = (218.31617 + 481267.88088*T - 1.3972*T)*DEGREE;
+    const double l = (134.96292 + 477198.86753*T)*DEGREE;
+    const double lp = (357.52543 + 35999.04944*T)*DEGREE;
+    const double F = (93.27283 + 483202.01873*T)*DEGREE;
+    const double D = (297.85027 + 445267.11135*T)*DEGREE;
+
+    const double lon = L0 + ARCSECOND*(22640*std::sin(l) + 769*std::sin(2*l) - 4586*std::sin(l - 2*D)
+        + 2370*std::sin(2*D) - 668*std::sin(lp) - 412*std::sin(2*F) - 212*std::sin(2*l - 2*D)
+        - 206*std::sin(l + lp - 2*D) + 192*std::sin(l + 2*D) - 165*std::sin(lp - 2*D)
+        + 148*std::sin(l - lp) - 125*std::sin(D) - 110*std::sin(l + lp) - 55*std::sin(2*F - 2*D));
+
+    const double lat = ARCSECOND*(18520*std::sin(F + lon - L0 + ARCSECOND*(412*std::sin(2*F) + 541*std::sin(lp)))
+        - 526*std::sin(F - 2*D) + 44*std::sin(l + F - 2*D) - 31*std::sin(-l + F - 2*D)
+        - 25*std::sin(-2*l + F) - 23*std::sin(lp + F - 2*D) + 21*std::sin(-l + F) + 11*std::sin(-lp + F - 2*D));
+
+    const double r = 385000 - 20905*std::cos(l) - 3699*std::cos(2*D - l) - 2956*std::cos(2*D)
+        - 570*std::cos(2*l) + 246*std::cos(2*l - 2*D) - 205*std::cos(lp - 2*D)
+        - 171*std::cos(l + 2*D) - 152*std::cos(l + lp - 2*D);
+
+    return fromEcliptic(lon, lat, r);
+}
+
+/* Perturbers */
+
+void Perturbers::add(ThirdBody body)
+{
+    if (body.table == nullptr)
+        throw std::invalid_argument("A third body needs a table of positions");
+    if (body.mu < 0)
+        throw std::invalid_argument("The gravitational parameter cannot be negative");
+
+    bodies.push_back(std::move(body));
+}
+
+void Perturbers::clear()
+{
+    bodies.clear();
+}
+
+unsigned int Perturbers::size() const
+{
+    return bodies.size();
+}
+
+const std::vector<ThirdBody>& Perturbers::getBodies() const
+{
+    return bodies;
+}
+
+void Perturbers::setEpoch(double seconds)
+{
+    epoch = seconds;
+}
+
+double Perturbers::getEpoch() const
+{
+    return epoch;
+}
+
+bool Perturbers::covers(double t0, double t1) const
+{
+    for (const ThirdBody& body : bodies)
+    {
+        if (!body.table->covers(epoch + t0, epoch + t1))
+            return false;
+    }
+    return true;
+}
+
+unsigned int Perturbers::load(std::istream& is)
+{
+    unsigned int read{0}, lineNumber{0};
+    std::string line;
+
+    while (nextLine(is, line, lineNumber))
+    {
+        std::istringstream sline(line);
+        std::string key, name, rest;
+        double mu;
+        if (!(sline >> key >> name >> mu) || key != "body" || sline >> rest)
+            throw lineError(lineNumber, "body name mu");
+
+        double start, span;
+        unsigned int segments, coefficients;
+        if (!nextLine(is, line, lineNumber))
+            throw lineError(lineNumber + 1, "table start span segments coefficients");
+
+        sline = std::istringstream(line);
+        if (!(sline >> key >> start >> span >> segments >> coefficients) || key != "table" || sline >> rest)
+            throw lineError(lineNumber, "table start span segments coefficients");
+
+        auto table = std::make_shared<ChebyshevTable>(start, span, segments, coefficients);
+        for (unsigned int s = 0; s < segments; s++)
+        {
+            if (!nextLine(is, line, lineNumber))
+                throw lineError(lineNumber + 1, std::to_string(3*coefficients) + " coefficients");
+
+            sline = std::istringstream(line);
+            double* c = table->coefficients(s);
+            for (unsigned int i = 0; i < 3*coefficients; i++)
+            {
+                if (!(sline >> c[i]))
+                    throw lineError(lineNumber, std::to_string(3*coefficients) + " coefficients");
+            }
+            if (sline >> rest)
+                throw lineError(lineNumber, std::to_string(3*coefficients) + " coefficients");
+        }
+
+        add({name, mu, std::move(table)});
+        read++;
+    }
+
+    return read;
+}
+
+void Perturbers::save(std::ostream& os) const
+{
+    os << std::setprecision(std::numeric_limits<double>::max_digits10);
+    for (const ThirdBody& body : bodies)
+    {
+        const ChebyshevTable& table = *body.table;
+        os << "body " << body.name << ' ' << body.mu << '\n';
+        os << "table " << table.getStart() << ' ' << table.getSpan() << ' '
+           << table.getSegments() << ' ' << table.getCoefficients() << '\n';
+
+        for (unsigned int s = 0; s < table.getSegments(); s++)
+        {
+            const double* c = table.coefficients(s);
+            for (unsigned int i = 0; i < 3*table.getCoefficients(); i++)
+                os << (i == 0 ? "" : " ") << c[i];
+            os << '\n';
+        }
+    }
+}
+
+/* ThirdBodyEvaluator */
+
+ThirdBodyEvaluator::ThirdBodyEvaluator(const ThirdBody& body, double epoch) :
+    table(body.table), mu(body.mu), epoch(epoch), lastTime(std::numeric_limits<double>::quiet_NaN())
+{
+}
+
+Vec3 ThirdBodyEvaluator::getPosition(double t) const
+{
+    const double T = epoch + t;
+    if (T == lastTime) return lastPosition;
+
+    // Times outside the table extrapolate its first or last segment
+    if (coefficients == nullptr || T < segmentStart || T > segmentEnd)
+    {
+        unsigned int s = table->segment(T);
+        coefficients = table->coefficients(s);
+        segmentStart = table->getStart() + s*table->getSpan();
+        segmentEnd = segmentStart + table->getSpan();
+    }
+
+    const unsigned int n = table->getCoefficients();
+    const double x = 2*(T - segmentStart)/table->getSpan() - 1;
+
+    lastTime = T;
+    lastPosition = Vec3{chebyshev(coefficients, n, x), chebyshev(coefficients + n, n, x),
+                        chebyshev(coefficients + 2*n, n, x)};
+    return lastPosition;
+}
+
+Vec3 ThirdBodyEvaluator::getAcceleration(double t, const Vec3& position) const
+{
+    // Attraction on the orbiting body minus that on the central body
+    const Vec3 s = getPosition(t);
+    const Vec3 d = s - position;
+
+    const double d2 = d[0]*d[0] + d[1]*d[1] + d[2]*d[2];
+    const double s2 = s[0]*s[0] + s[1]*s[1] + s[2]*s[2];
+    const double invD3 = 1/(d2*std::sqrt(d2)), invS3 = 1/(s2*std::sqrt(s2));
+
+    return mu*(invD3*d - invS3*s);
+}
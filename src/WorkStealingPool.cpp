@@ -0,0 +1,131 @@
+#include "WorkStealingPool.hpp"
+#include <algorithm>
+
+WorkStealingPool::WorkStealingPool(unsigned int n)
+{
+    if (n == 0)
+        n = std::max(1u, std::thread::hardware_concurrency());
+
+    for (unsigned int i = 0; i < n; i++)
+        queues.emplace_back(new Queue());
+
+    for (unsigned int i = 0; i < n; i++)
+        threads.emplace_back(&WorkStealingPool::work, this, i);
+}
+
+WorkStealingPool::~WorkStealingPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    started.notify_all();
+
+    for (auto& thread : threads)
+        thread.join();
+}
+
+unsigned int WorkStealingPool::size() const
+{
+    return threads.size();
+}
+
+void WorkStealingPool::run(const std::vector<unsigned int>& order, const std::function<void(unsigned int)>& task)
+{
+    if (order.empty()) return;
+
+    // Deal tasks like cards so every worker starts with a similar share
+    for (unsigned int i = 0; i < order.size(); i++)
+    {
+        Queue& queue = *queues[i % queues.size()];
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        queue.tasks.push_back(order[i]);
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        current = &task;
+        busy = threads.size();
+        failed = false;
+        error = nullptr;
+        generation++;
+    }
+    started.notify_all();
+
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        finished.wait(lock, [this]() { return busy == 0; });
+        current = nullptr;
+    }
+
+    if (error)
+        std::rethrow_exception(error);
+}
+
+void WorkStealingPool::work(unsigned int id)
+{
+    unsigned long seen{0};
+
+    while (true)
+    {
+        const std::function<void(unsigned int)>* task;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            started.wait(lock, [this, seen]() { return stopping || generation != seen; });
+            if (stopping) return;
+
+            seen = generation;
+            task = current;
+        }
+
+        unsigned int n;
+        while (next(id, n))
+        {
+            try
+            {
+                (*task)(n);
+            }
+            catch (...)
+            {
+                bool expected{false};
+                if (failed.compare_exchange_strong(expected, true))
+                    error = std::current_exception();
+            }
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (--busy == 0)
+                finished.notify_all();
+        }
+    }
+}
+
+bool WorkStealingPool::next(unsigned int id, unsigned int& task)
+{
+    {
+        Queue& own = *queues[id];
+        std::lock_guard<std::mutex> lock(own.mutex);
+        if (!own.tasks.empty())
+        {
+            task = own.tasks.front();
+            own.tasks.pop_front();
+            return true;
+        }
+    }
+
+    // Tasks never create new tasks, so once every queue is empty the work is done
+    for (unsigned int k = 1; k < queues.size(); k++)
+    {
+        Queue& victim = *queues[(id + k) % queues.size()];
+        std::lock_guard<std::mutex> lock(victim.mutex);
+        if (!victim.tasks.empty())
+        {
+            task = victim.tasks.back();
+            victim.tasks.pop_back();
+            return true;
+        }
+    }
+
+    return false;
+}
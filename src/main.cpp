@@ -1,8 +1,23 @@
 #include "ConsoleHandler.hpp"
+#include <cstring>
 
-int main() 
+int main(int argc, char* argv[])
 {
     Enviroment enviroment;
     ConsoleHandler handler{enviroment, std::cin, std::cout};
-    handler.startQuery();
+
+    if (argc == 1)
+    {
+        handler.startQuery();
+        return 0;
+    }
+
+    // OrbitalCalculator --script file...: runs scenario files without prompts
+    if (std::strcmp(argv[1], "--script") != 0 || argc < 3)
+    {
+        std::cerr << "Usage: " << argv[0] << " [--script file...]" << std::endl;
+        return ConsoleHandler::SCRIPT_INVALID;
+    }
+
+    return handler.runScripts(std::vector<std::string>(argv + 2, argv + argc));
 }
\ No newline at end of file
@@ -0,0 +1,129 @@
+#include "BatchKernels.hpp"
+#include "GravityModel.hpp"
+#include <cmath>
+#include <iostream>
+#include <string>
+
+/* Golden test of the J2/J3 accelerations: both the kernel of the propagators
+ * and that of the batch must be the gradient of the zonal potential
+ *
+ *     V = mu/r - K2/r^3 P2(z/r) - K3/r^4 P3(z/r),  Kn = mu*Jn*R^n
+ *
+ * which is computed here independently by finite differences. */
+
+namespace
+{
+    const double MU = 398600.4418, RADIUS = 6378.137;
+    const double K2 = MU*1.08262668e-3*RADIUS*RADIUS;
+    const double K3 = MU*-2.53265649e-6*RADIUS*RADIUS*RADIUS;
+
+    /// Zonal part of the potential in km^2/s^2, with the terms that are set
+    double zonalPotential(const Vec3& r, bool J2, bool J3)
+    {
+        const double d = r.norm(), s = r[2]/d;
+        double V{0};
+        if (J2) V -= K2/(d*d*d)*(3*s*s - 1)/2;
+        if (J3) V -= K3/(d*d*d*d)*(5*s*s*s - 3*s)/2;
+        return V;
+    }
+
+    /// Gradient of zonalPotential by fourth order central differences
+    Vec3 zonalGradient(const Vec3& r, bool J2, bool J3)
+    {
+        const double h = 1e-2;
+        Vec3 g;
+        for (unsigned int axis = 0; axis < 3; axis++)
+        {
+            auto at = [&](double offset)
+            {
+                Vec3 p = r;
+                p[axis] += offset;
+                return zonalPotential(p, J2, J3);
+            };
+            g[axis] = (8*(at(h) - at(-h)) - (at(2*h) - at(-2*h)))/(12*h);
+        }
+        return g;
+    }
+
+    /// One double with the operations batchAcceleration needs
+    struct Scalar
+    {
+        Scalar(double v = 0) : v(v) {};
+        double v;
+    };
+    Scalar operator+(Scalar a, Scalar b) { return a.v + b.v; }
+    Scalar operator-(Scalar a, Scalar b) { return a.v - b.v; }
+    Scalar operator*(Scalar a, Scalar b) { return a.v * b.v; }
+    Scalar operator/(Scalar a, Scalar b) { return a.v / b.v; }
+    Scalar sqrt(Scalar a) { return std::sqrt(a.v); }
+
+    template <bool J2, bool J3>
+    Vec3 batch(const Vec3& r)
+    {
+        BatchKernelParams p{};
+        p.mu = MU;
+        p.J2 = K2;
+        p.J3 = K3;
+        p.hasJ2 = J2;
+        p.hasJ3 = J3;
+        Scalar ax, ay, az;
+        batchAcceleration<Scalar, J2, J3>(r[0], r[1], r[2], p, ax, ay, az);
+        return {ax.v, ay.v, az.v};
+    }
+
+    unsigned int failures{0};
+
+    /** Checks that the zonal part of @param a, the acceleration of @param kernel
+     *  at @param r, is the gradient of the potential within 1e-7 of its size,
+     *  or of the point mass term when there are no zonal terms
+     */
+    template <bool J2, bool J3>
+    void check(const std::string& kernel, const Vec3& r, const Vec3& a)
+    {
+        const Vec3 pointMass = (-MU/std::pow(r.norm(), 3))*r;
+        const Vec3 expected = zonalGradient(r, J2, J3);
+        const double error = (a - pointMass - expected).norm();
+        const double scale = J2 || J3 ? expected.norm() : pointMass.norm();
+
+        if (!(error <= 1e-7*scale))
+        {
+            failures++;
+            std::cerr << "FAILED " << kernel << "<" << J2 << ", " << J3 << "> at (" << r[0] << ", " << r[1]
+                      << ", " << r[2] << "): error " << error << " km/s^2 for " << expected.norm() << std::endl;
+        }
+    }
+
+    template <bool J2, bool J3>
+    void checkAll()
+    {
+        // LEO and GEO, equatorial, both hemispheres and near the pole
+        const Vec3 positions[] = {{6778, 0, 0}, {4500, 3200, 3900}, {-2100, 5200, -4300},
+                                  {300, -200, 6900}, {42164, 0, 0}, {-15000, 30000, 20000}};
+        ZonalParameters parameters;
+        parameters.mu = MU;
+        parameters.K2 = J2 ? K2 : 0;
+        parameters.K3 = J3 ? K3 : 0;
+
+        for (const Vec3& r : positions)
+        {
+            check<J2, J3>("zonalAcceleration", r, zonalAcceleration<J2, J3>(r, parameters));
+            check<J2, J3>("batchAcceleration", r, batch<J2, J3>(r));
+        }
+    }
+}
+
+int main()
+{
+    checkAll<false, false>();
+    checkAll<true, false>();
+    checkAll<false, true>();
+    checkAll<true, true>();
+
+    if (failures > 0)
+    {
+        std::cerr << failures << " checks failed" << std::endl;
+        return 1;
+    }
+    std::cout << "Zonal accelerations match the gradient of the potential" << std::endl;
+    return 0;
+}